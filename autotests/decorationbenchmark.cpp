@@ -0,0 +1,314 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+// Paints the decoration offscreen, against mocked KWin objects, for every
+// button style. QBENCHMARK reports the time per frame, each row also logs
+// the frame rate and what a single frame allocates. paintButton does the
+// same for each button on its own.
+//
+// Set SIERRABREEZEENHANCED_GOLDEN_DIR to compare every frame to a golden
+// image in that directory. Missing images are written instead, so a first
+// run on a known good build records them.
+
+#include "allocationcounter.h"
+#include "mockdecorationbridge.h"
+
+#include <KConfigGroup>
+#include <KDecoration3/Decoration>
+#include <KDecoration3/DecorationButton>
+#include <KDecoration3/DecorationSettings>
+#include <KPluginFactory>
+#include <KPluginMetaData>
+#include <KSharedConfig>
+
+#include <QDir>
+#include <QElapsedTimer>
+#include <QHoverEvent>
+#include <QPainter>
+#include <QStandardPaths>
+#include <QTest>
+#include <QtMath>
+
+#include <memory>
+#include <utility>
+
+using namespace Breeze;
+
+Q_DECLARE_METATYPE(KDecoration3::DecorationButtonType)
+
+namespace
+{
+const QSize s_windowSizes[] = {QSize(480, 320), QSize(1920, 1080)};
+
+// Number of choices of the ButtonStyle entry in breezesettingsdata.kcfg
+const int s_buttonStyleCount = 14;
+
+// Frames painted to measure the frame rate
+const int s_frameRateSamples = 20;
+}
+
+class DecorationBenchmark : public QObject
+{
+    Q_OBJECT
+
+public:
+    static void initMain();
+
+private Q_SLOTS:
+    void initTestCase();
+
+    void paint_data();
+    void paint();
+
+    void paintButton_data();
+    void paintButton();
+
+private:
+    void configure(int buttonStyle);
+    std::unique_ptr<KDecoration3::Decoration> createDecoration(const MockWindowState &state);
+    void compareToGolden(const QImage &image);
+    static KDecoration3::DecorationButton *findButton(KDecoration3::Decoration *decoration, KDecoration3::DecorationButtonType type);
+    static void hover(KDecoration3::Decoration *decoration, KDecoration3::DecorationButton *button);
+
+    MockBridge m_bridge;
+    std::shared_ptr<KDecoration3::DecorationSettings> m_settings;
+    KPluginFactory *m_factory = nullptr;
+};
+
+void DecorationBenchmark::initMain()
+{
+    // no display needed, and the user's configuration and shadow atlas stay untouched
+    qputenv("QT_QPA_PLATFORM", "offscreen");
+    QStandardPaths::setTestModeEnabled(true);
+}
+
+void DecorationBenchmark::initTestCase()
+{
+    QFile::remove(QStandardPaths::writableLocation(QStandardPaths::GenericConfigLocation) + QStringLiteral("/sierrabreezeenhancedrc"));
+
+    const auto result = KPluginFactory::loadFactory(KPluginMetaData(QStringLiteral(SIERRABREEZEENHANCED_PLUGIN)));
+    QVERIFY2(result, qPrintable(result.errorText));
+    m_factory = result.plugin;
+
+    m_settings = std::make_shared<KDecoration3::DecorationSettings>(&m_bridge);
+}
+
+void DecorationBenchmark::configure(int buttonStyle)
+{
+    KSharedConfig::Ptr config = KSharedConfig::openConfig(QStringLiteral("sierrabreezeenhancedrc"));
+    KConfigGroup group = config->group(QStringLiteral("Windeco"));
+    group.writeEntry("ButtonStyle", buttonStyle);
+
+    // a hovered button is painted in its final state right away
+    group.writeEntry("AnimationsEnabled", false);
+    config->sync();
+}
+
+std::unique_ptr<KDecoration3::Decoration> DecorationBenchmark::createDecoration(const MockWindowState &state)
+{
+    m_bridge.setWindowState(state);
+
+    // the same arguments KWin passes
+    const QVariantMap arguments{{QStringLiteral("bridge"), QVariant::fromValue(static_cast<KDecoration3::DecorationBridge *>(&m_bridge))}};
+    std::unique_ptr<KDecoration3::Decoration> decoration(m_factory->create<KDecoration3::Decoration>(nullptr, QVariantList{arguments}));
+    if (!decoration) {
+        return nullptr;
+    }
+
+    decoration->setSettings(m_settings);
+    decoration->create();
+    if (!decoration->init()) {
+        return nullptr;
+    }
+
+    // as KWin does once the configuration module saved, picks up the new style
+    Q_EMIT m_settings->reconfigured();
+
+    // button geometry is laid out from the event loop
+    QCoreApplication::processEvents();
+    return decoration;
+}
+
+void DecorationBenchmark::compareToGolden(const QImage &image)
+{
+    const QString directory = qEnvironmentVariable("SIERRABREEZEENHANCED_GOLDEN_DIR");
+    if (directory.isEmpty()) {
+        return;
+    }
+
+    const QString fileName = QDir(directory).filePath(QString::fromLatin1(QTest::currentDataTag()).replace(QLatin1Char(' '), QLatin1Char('-')) + QStringLiteral(".png"));
+    if (!QFile::exists(fileName)) {
+        QVERIFY(QDir().mkpath(directory));
+        QVERIFY(image.save(fileName));
+        return;
+    }
+
+    const QImage golden = QImage(fileName).convertToFormat(image.format());
+    QCOMPARE(image, golden);
+}
+
+KDecoration3::DecorationButton *DecorationBenchmark::findButton(KDecoration3::Decoration *decoration, KDecoration3::DecorationButtonType type)
+{
+    const auto buttons = decoration->findChildren<KDecoration3::DecorationButton *>();
+    for (KDecoration3::DecorationButton *button : buttons) {
+        if (button->type() == type) {
+            return button;
+        }
+    }
+
+    return nullptr;
+}
+
+void DecorationBenchmark::hover(KDecoration3::Decoration *decoration, KDecoration3::DecorationButton *button)
+{
+    const QPointF position = button->geometry().center();
+    QHoverEvent enter(QEvent::HoverEnter, position, position, QPointF(-1, -1));
+    QCoreApplication::sendEvent(decoration, &enter);
+    QHoverEvent move(QEvent::HoverMove, position, position, position);
+    QCoreApplication::sendEvent(decoration, &move);
+}
+
+void DecorationBenchmark::paint_data()
+{
+    QTest::addColumn<QSize>("windowSize");
+    QTest::addColumn<int>("buttonStyle");
+    QTest::addColumn<bool>("active");
+    QTest::addColumn<bool>("hovered");
+
+    for (const QSize &windowSize : s_windowSizes) {
+        for (int buttonStyle = 0; buttonStyle < s_buttonStyleCount; ++buttonStyle) {
+            for (const bool active : {true, false}) {
+                for (const bool hovered : {false, true}) {
+                    QTest::addRow("%dx%d style%d %s %s",
+                                  windowSize.width(),
+                                  windowSize.height(),
+                                  buttonStyle,
+                                  active ? "active" : "inactive",
+                                  hovered ? "hovered" : "idle")
+                        << windowSize << buttonStyle << active << hovered;
+                }
+            }
+        }
+    }
+}
+
+void DecorationBenchmark::paint()
+{
+    QFETCH(QSize, windowSize);
+    QFETCH(int, buttonStyle);
+    QFETCH(bool, active);
+    QFETCH(bool, hovered);
+
+    configure(buttonStyle);
+
+    MockWindowState state;
+    state.size = windowSize;
+    state.active = active;
+    const std::unique_ptr<KDecoration3::Decoration> decoration = createDecoration(state);
+    QVERIFY(decoration);
+
+    if (hovered) {
+        KDecoration3::DecorationButton *closeButton = findButton(decoration.get(), KDecoration3::DecorationButtonType::Close);
+        QVERIFY(closeButton);
+        hover(decoration.get(), closeButton);
+        QVERIFY(closeButton->isHovered());
+    }
+
+    const QRectF rect = decoration->rect();
+    QImage image(QSize(qCeil(rect.width()), qCeil(rect.height())), QImage::Format_ARGB32_Premultiplied);
+    const auto paintFrame = [&]() {
+        image.fill(Qt::transparent);
+        QPainter painter(&image);
+        painter.setRenderHint(QPainter::Antialiasing);
+        decoration->paint(&painter, rect);
+    };
+
+    // the first frame fills the caches shared by all decorations, the others reuse them
+    paintFrame();
+    compareToGolden(image);
+
+    AllocationCounter::report(paintFrame);
+
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < s_frameRateSamples; ++i) {
+        paintFrame();
+    }
+    qInfo().nospace() << "frames per second: " << qRound(s_frameRateSamples * 1e9 / qMax<qint64>(1, timer.nsecsElapsed()));
+
+    QBENCHMARK {
+        paintFrame();
+    }
+}
+
+void DecorationBenchmark::paintButton_data()
+{
+    QTest::addColumn<int>("buttonStyle");
+    QTest::addColumn<KDecoration3::DecorationButtonType>("type");
+    QTest::addColumn<bool>("active");
+    QTest::addColumn<bool>("hovered");
+
+    const std::pair<KDecoration3::DecorationButtonType, const char *> types[] = {
+        {KDecoration3::DecorationButtonType::Close, "close"},
+        {KDecoration3::DecorationButtonType::Maximize, "maximize"},
+        {KDecoration3::DecorationButtonType::Minimize, "minimize"},
+        {KDecoration3::DecorationButtonType::OnAllDesktops, "onalldesktops"},
+    };
+
+    for (int buttonStyle = 0; buttonStyle < s_buttonStyleCount; ++buttonStyle) {
+        for (const auto &[type, typeName] : types) {
+            for (const bool active : {true, false}) {
+                for (const bool hovered : {false, true}) {
+                    QTest::addRow("style%d %s %s %s", buttonStyle, typeName, active ? "active" : "inactive", hovered ? "hovered" : "idle")
+                        << buttonStyle << type << active << hovered;
+                }
+            }
+        }
+    }
+}
+
+void DecorationBenchmark::paintButton()
+{
+    QFETCH(int, buttonStyle);
+    QFETCH(KDecoration3::DecorationButtonType, type);
+    QFETCH(bool, active);
+    QFETCH(bool, hovered);
+
+    configure(buttonStyle);
+
+    MockWindowState state;
+    state.active = active;
+    const std::unique_ptr<KDecoration3::Decoration> decoration = createDecoration(state);
+    QVERIFY(decoration);
+
+    KDecoration3::DecorationButton *button = findButton(decoration.get(), type);
+    QVERIFY(button);
+    if (hovered) {
+        hover(decoration.get(), button);
+        QVERIFY(button->isHovered());
+    }
+
+    // painted where the decoration puts it, on an image just covering the button
+    const QRectF geometry = button->geometry();
+    QImage image(QSize(qCeil(geometry.width()), qCeil(geometry.height())), QImage::Format_ARGB32_Premultiplied);
+    const auto paintButton = [&]() {
+        image.fill(Qt::transparent);
+        QPainter painter(&image);
+        painter.setRenderHint(QPainter::Antialiasing);
+        painter.translate(-geometry.topLeft());
+        button->paint(&painter, geometry);
+    };
+
+    // the first paint renders the icon sprite, later ones reuse it
+    paintButton();
+    AllocationCounter::report(paintButton);
+
+    QBENCHMARK {
+        paintButton();
+    }
+}
+
+QTEST_MAIN(DecorationBenchmark)
+
+#include "decorationbenchmark.moc"
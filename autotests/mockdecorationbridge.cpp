@@ -0,0 +1,240 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "mockdecorationbridge.h"
+
+#include <QGuiApplication>
+#include <QIcon>
+#include <QPalette>
+
+namespace Breeze
+{
+MockWindow::MockWindow(KDecoration3::DecoratedWindow *window, KDecoration3::Decoration *decoration, const MockWindowState &state)
+    : KDecoration3::DecoratedWindowPrivate(window, decoration)
+    , m_state(state)
+{
+}
+
+bool MockWindow::isActive() const
+{
+    return m_state.active;
+}
+
+QString MockWindow::caption() const
+{
+    return m_state.caption;
+}
+
+bool MockWindow::isOnAllDesktops() const
+{
+    return false;
+}
+
+bool MockWindow::isShaded() const
+{
+    return false;
+}
+
+QIcon MockWindow::icon() const
+{
+    return QIcon();
+}
+
+bool MockWindow::isMaximized() const
+{
+    return false;
+}
+
+bool MockWindow::isMaximizedHorizontally() const
+{
+    return false;
+}
+
+bool MockWindow::isMaximizedVertically() const
+{
+    return false;
+}
+
+bool MockWindow::isKeepAbove() const
+{
+    return false;
+}
+
+bool MockWindow::isKeepBelow() const
+{
+    return false;
+}
+
+bool MockWindow::isCloseable() const
+{
+    return true;
+}
+
+bool MockWindow::isMaximizeable() const
+{
+    return true;
+}
+
+bool MockWindow::isMinimizeable() const
+{
+    return true;
+}
+
+bool MockWindow::providesContextHelp() const
+{
+    return false;
+}
+
+bool MockWindow::isModal() const
+{
+    return false;
+}
+
+bool MockWindow::isShadeable() const
+{
+    return true;
+}
+
+bool MockWindow::isMoveable() const
+{
+    return true;
+}
+
+bool MockWindow::isResizeable() const
+{
+    return true;
+}
+
+qreal MockWindow::width() const
+{
+    return m_state.size.width();
+}
+
+qreal MockWindow::height() const
+{
+    return m_state.size.height();
+}
+
+QSizeF MockWindow::size() const
+{
+    return m_state.size;
+}
+
+QPalette MockWindow::palette() const
+{
+    return QGuiApplication::palette();
+}
+
+Qt::Edges MockWindow::adjacentScreenEdges() const
+{
+    return Qt::Edges();
+}
+
+QString MockWindow::windowClass() const
+{
+    return QStringLiteral("offscreen offscreen");
+}
+
+void MockWindow::requestShowToolTip(const QString &)
+{
+}
+
+void MockWindow::requestHideToolTip()
+{
+}
+
+void MockWindow::requestClose()
+{
+}
+
+void MockWindow::requestToggleMaximization(Qt::MouseButtons)
+{
+}
+
+void MockWindow::requestMinimize()
+{
+}
+
+void MockWindow::requestContextHelp()
+{
+}
+
+void MockWindow::requestToggleOnAllDesktops()
+{
+}
+
+void MockWindow::requestToggleShade()
+{
+}
+
+void MockWindow::requestToggleKeepAbove()
+{
+}
+
+void MockWindow::requestToggleKeepBelow()
+{
+}
+
+void MockWindow::requestShowWindowMenu(const QRect &)
+{
+}
+
+qreal MockWindow::scale() const
+{
+    return 1.0;
+}
+
+qreal MockWindow::nextScale() const
+{
+    return 1.0;
+}
+
+//________________________________________________________________
+MockSettings::MockSettings(KDecoration3::DecorationSettings *parent)
+    : KDecoration3::DecorationSettingsPrivate(parent)
+{
+}
+
+bool MockSettings::isOnAllDesktopsAvailable() const
+{
+    return true;
+}
+
+bool MockSettings::isAlphaChannelSupported() const
+{
+    return true;
+}
+
+bool MockSettings::isCloseOnDoubleClickOnMenu() const
+{
+    return false;
+}
+
+QList<KDecoration3::DecorationButtonType> MockSettings::decorationButtonsLeft() const
+{
+    return {KDecoration3::DecorationButtonType::Menu, KDecoration3::DecorationButtonType::OnAllDesktops};
+}
+
+QList<KDecoration3::DecorationButtonType> MockSettings::decorationButtonsRight() const
+{
+    return {KDecoration3::DecorationButtonType::Minimize, KDecoration3::DecorationButtonType::Maximize, KDecoration3::DecorationButtonType::Close};
+}
+
+KDecoration3::BorderSize MockSettings::borderSize() const
+{
+    return KDecoration3::BorderSize::Normal;
+}
+
+//________________________________________________________________
+std::unique_ptr<KDecoration3::DecoratedWindowPrivate> MockBridge::createClient(KDecoration3::DecoratedWindow *window, KDecoration3::Decoration *decoration)
+{
+    return std::make_unique<MockWindow>(window, decoration, m_windowState);
+}
+
+std::unique_ptr<KDecoration3::DecorationSettingsPrivate> MockBridge::settings(KDecoration3::DecorationSettings *parent)
+{
+    return std::make_unique<MockSettings>(parent);
+}
+
+} // namespace Breeze
@@ -0,0 +1,120 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#pragma once
+
+// Stand-ins for the parts of KWin a decoration talks to, so that the plugin
+// can be created and painted without a compositor.
+
+#include <KDecoration3/Private/DecoratedWindowPrivate>
+#include <KDecoration3/Private/DecorationBridge>
+#include <KDecoration3/Private/DecorationSettingsPrivate>
+
+#include <QSizeF>
+#include <QString>
+
+namespace Breeze
+{
+/**
+ * The state a mocked window reports. Fixed for the lifetime of the window,
+ * create a new decoration to paint another state.
+ **/
+struct MockWindowState {
+    QSizeF size = QSizeF(800, 600);
+    bool active = true;
+    QString caption = QStringLiteral("Offscreen window");
+};
+
+/**
+ * A window that never changes and ignores every request.
+ **/
+class MockWindow : public KDecoration3::DecoratedWindowPrivate
+{
+public:
+    MockWindow(KDecoration3::DecoratedWindow *window, KDecoration3::Decoration *decoration, const MockWindowState &state);
+
+    bool isActive() const override;
+    QString caption() const override;
+    bool isOnAllDesktops() const override;
+    bool isShaded() const override;
+    QIcon icon() const override;
+    bool isMaximized() const override;
+    bool isMaximizedHorizontally() const override;
+    bool isMaximizedVertically() const override;
+    bool isKeepAbove() const override;
+    bool isKeepBelow() const override;
+
+    bool isCloseable() const override;
+    bool isMaximizeable() const override;
+    bool isMinimizeable() const override;
+    bool providesContextHelp() const override;
+    bool isModal() const override;
+    bool isShadeable() const override;
+    bool isMoveable() const override;
+    bool isResizeable() const override;
+
+    qreal width() const override;
+    qreal height() const override;
+    QSizeF size() const override;
+    QPalette palette() const override;
+    Qt::Edges adjacentScreenEdges() const override;
+    QString windowClass() const override;
+
+    void requestShowToolTip(const QString &text) override;
+    void requestHideToolTip() override;
+    void requestClose() override;
+    void requestToggleMaximization(Qt::MouseButtons buttons) override;
+    void requestMinimize() override;
+    void requestContextHelp() override;
+    void requestToggleOnAllDesktops() override;
+    void requestToggleShade() override;
+    void requestToggleKeepAbove() override;
+    void requestToggleKeepBelow() override;
+    void requestShowWindowMenu(const QRect &rect) override;
+
+    qreal scale() const override;
+    qreal nextScale() const override;
+
+private:
+    MockWindowState m_state;
+};
+
+/**
+ * Global decoration settings, as KWin's defaults.
+ **/
+class MockSettings : public KDecoration3::DecorationSettingsPrivate
+{
+public:
+    explicit MockSettings(KDecoration3::DecorationSettings *parent);
+
+    bool isOnAllDesktopsAvailable() const override;
+    bool isAlphaChannelSupported() const override;
+    bool isCloseOnDoubleClickOnMenu() const override;
+    QList<KDecoration3::DecorationButtonType> decorationButtonsLeft() const override;
+    QList<KDecoration3::DecorationButtonType> decorationButtonsRight() const override;
+    KDecoration3::BorderSize borderSize() const override;
+};
+
+/**
+ * Hands out mocked windows and settings to the decorations created with it.
+ **/
+class MockBridge : public KDecoration3::DecorationBridge
+{
+public:
+    std::unique_ptr<KDecoration3::DecoratedWindowPrivate> createClient(KDecoration3::DecoratedWindow *window, KDecoration3::Decoration *decoration) override;
+    std::unique_ptr<KDecoration3::DecorationSettingsPrivate> settings(KDecoration3::DecorationSettings *parent) override;
+
+    /**
+     * The state of the windows created from now on.
+     **/
+    void setWindowState(const MockWindowState &state)
+    {
+        m_windowState = state;
+    }
+
+private:
+    MockWindowState m_windowState;
+};
+
+} // namespace Breeze
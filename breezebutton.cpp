@@ -19,13 +19,67 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 #include "breezebutton.h"
+#include "breezepaintprofiler.h"
 
 #include <KDecoration3/DecoratedWindow>
 #include <KColorUtils>
 #include <KIconLoader>
 
+#include <QCache>
 #include <QPainter>
 #include <QPainterPath>
+#include <QtMath>
+
+#include <iterator>
+
+namespace
+{
+    //* everything a rasterized button icon depends on
+    struct ButtonSpriteKey
+    {
+        int style = 0;
+        int type = 0;
+        bool checked = false;
+        bool hovered = false;
+        bool directlyHovered = false;
+        bool pressed = false;
+        bool active = false;
+        bool animating = false;
+        int opacityStep = 0;
+        QRgb titleBarColor = 0;
+        QRgb fontColor = 0;
+        QRgb warningColor = 0;
+        bool lightTitleBar = false;
+        bool animationsEnabled = false;
+        bool matchColorForTitleBar = false;
+        bool systemForegroundColor = false;
+        int iconWidth = 0;
+        int iconHeight = 0;
+        qreal width = 0;
+        qreal height = 0;
+        int phaseX = 0;
+        int phaseY = 0;
+        qreal devicePixelRatio = 1.0;
+
+        bool operator==(const ButtonSpriteKey &other) const = default;
+    };
+
+    inline size_t qHash(const ButtonSpriteKey &key, size_t seed = 0)
+    {
+        return qHashMulti(seed, key.style, key.type, key.checked, key.hovered, key.directlyHovered, key.pressed, key.active, key.animating, key.opacityStep,
+            key.titleBarColor, key.fontColor, key.warningColor, key.lightTitleBar, key.animationsEnabled, key.matchColorForTitleBar, key.systemForegroundColor,
+            key.iconWidth, key.iconHeight, key.width, key.height, key.phaseX, key.phaseY, key.devicePixelRatio);
+    }
+
+    //* size of the sprite cache, in kilobytes. The least recently used sprites go first
+    const int s_buttonSpriteCacheCost = 8*1024;
+
+    //* sub pixel positions a sprite is rendered at, per axis. Icons are off their exact position by up to half a step
+    const int s_buttonSpritePhases = 4;
+
+    //* room left around the button for antialiasing, in device pixels
+    const int s_buttonSpriteMargin = 2;
+}
 
 namespace Breeze
 {
@@ -34,10 +88,14 @@ namespace Breeze
     using KDecoration3::ColorGroup;
     using KDecoration3::DecorationButtonType;
 
+    //* button icons shared by all decorations
+    static QCache<ButtonSpriteKey, QImage> g_buttonSprites( s_buttonSpriteCacheCost );
+
 
     //__________________________________________________________________
     Button::Button(DecorationButtonType type, Decoration* decoration, QObject* parent)
         : DecorationButton(type, decoration, parent)
+        , m_decoration( decoration )
         , m_animation( new QVariantAnimation( this ) )
     {
 
@@ -48,7 +106,9 @@ namespace Breeze
         // Linear to have the same easing as Breeze animations
         m_animation->setEasingCurve( QEasingCurve::Linear );
         connect(m_animation, &QVariantAnimation::valueChanged, this, [this](const QVariant &value) {
-            setOpacity(value.toReal());
+            // quantized, so that every frame of the transition is rendered once and then served from the sprites
+            const int steps = m_animationFrames - 1;
+            setOpacity(qreal(qRound(value.toReal()*steps))/steps);
         });
 
         // setup default geometry
@@ -133,15 +193,18 @@ namespace Breeze
     //__________________________________________________________________
     void Button::paint(QPainter *painter, const QRectF &repaintRegion)
     {
-        Q_UNUSED(repaintRegion)
-
         if (!decoration()) return;
 
+        // nothing to do if the button is not part of the dirty area
+        const QPointF offset( renderOffset() );
+        if( !geometry().united( geometry().translated( offset ) ).intersects( repaintRegion ) ) return;
+
+        updatePaintContext();
+
         painter->save();
 
         // translate from offset
-        if( m_flag == FlagFirstInList ) painter->translate( m_offset );
-        else painter->translate( 0, m_offset.y() );
+        painter->translate( offset );
 
         if( !m_iconSize.isValid() || isStandAlone() ) m_iconSize = geometry().size().toSize();
 
@@ -152,7 +215,7 @@ namespace Breeze
             const QRectF iconRect( geometry().topLeft(), 0.8*m_iconSize );
             const qreal width( m_iconSize.width() );
             painter->translate( 0.1*width, 0.1*width );
-            if (auto deco =  qobject_cast<Decoration*>(decoration())) {
+            if (auto deco = m_decoration.data()) {
               const QPalette activePalette = KIconLoader::global()->customPalette();
               QPalette palette = decoration()->window()->palette();
               palette.setColor(QPalette::WindowText, deco->fontColor());
@@ -169,35 +232,148 @@ namespace Breeze
 
         } else {
 
-            auto d = qobject_cast<Decoration*>( decoration() );
-
-            if ( d && d->internalSettings()->buttonStyle() == 0 )
-                drawIconPlasma( painter );
-            else if ( d && d->internalSettings()->buttonStyle() == 1 )
-                drawIconGnome( painter );
-            else if ( d && d->internalSettings()->buttonStyle() == 2 )
-                drawIconMacSierra( painter );
-            else if ( d && d->internalSettings()->buttonStyle() == 3 )
-                drawIconMacDarkAurorae( painter );
-            else if ( d && ( d->internalSettings()->buttonStyle() == 4 || d->internalSettings()->buttonStyle() == 5 || d->internalSettings()->buttonStyle() == 6 ) )
-                drawIconSBEsierra( painter );
-            else if ( d && ( d->internalSettings()->buttonStyle() == 7 || d->internalSettings()->buttonStyle() == 8 || d->internalSettings()->buttonStyle() == 9 ) )
-                drawIconSBEdarkAurorae( painter );
-            else if ( d && d->internalSettings()->buttonStyle() == 10 )
-                drawIconSierraColorSymbols( painter );
-            else if ( d && d->internalSettings()->buttonStyle() == 11 )
-                drawIconDarkAuroraeColorSymbols( painter );
-            else if ( d && d->internalSettings()->buttonStyle() == 12 )
-                drawIconSierraMonochromeSymbols( painter );
-            else if ( d && d->internalSettings()->buttonStyle() == 13 )
-                drawIconDarkAuroraeMonochromeSymbols( painter );
+            PaintProfiler::Scope profile( PaintProfiler::ButtonStyle + m_buttonStyle );
+
+            Blit blit;
+            if( iconSprite( painter->transform(), painter->device()->devicePixelRatioF(), blit ) )
+            {
+                // back to logical coordinates, untransformed
+                painter->resetTransform();
+                painter->drawImage( blit.position, blit.image );
+
+            } else (this->*m_drawIcon)( painter );
+
+        }
+
+        painter->restore();
+
+    }
+
+    //__________________________________________________________________
+    void Button::paintBatched(QPainter *painter, const QRectF &repaintRegion, QList<Blit> &blits)
+    {
+        // the window icon does not come from the sprites
+        if( type() == DecorationButtonType::Menu ) return paint( painter, repaintRegion );
+
+        if (!decoration()) return;
+
+        const QPointF offset( renderOffset() );
+        if( !geometry().united( geometry().translated( offset ) ).intersects( repaintRegion ) ) return;
 
+        updatePaintContext();
+
+        if( !m_iconSize.isValid() ) m_iconSize = geometry().size().toSize();
+
+        PaintProfiler::Scope profile( PaintProfiler::ButtonStyle + m_buttonStyle );
+
+        // the offset is folded into the transform the sprite is looked up for, rather than set on the painter
+        Blit blit;
+        if( iconSprite( QTransform::fromTranslate( offset.x(), offset.y() ) * painter->transform(), painter->device()->devicePixelRatioF(), blit ) )
+        {
+            blits.append( blit );
+            return;
         }
 
+        painter->save();
+        painter->translate( offset );
+        (this->*m_drawIcon)( painter );
         painter->restore();
 
     }
 
+    //__________________________________________________________________
+    void Button::updatePaintContext()
+    {
+        auto d = m_decoration.data();
+        if( !d ) return;
+
+        const Decoration::Colors &colors( d->colors() );
+        m_context.active = d->window()->isActive();
+        m_context.hovered = hovered();
+        m_context.animationsEnabled = d->internalSettings()->animationsEnabled();
+        m_context.matchColorForTitleBar = d->internalSettings()->matchColorForTitleBar();
+        m_context.systemForegroundColor = d->internalSettings()->systemForegroundColor();
+        m_context.lightTitleBar = colors.lightTitleBar;
+        m_context.titleBarColor = colors.titleBar;
+        m_context.fontColor = colors.font;
+    }
+
+    //__________________________________________________________________
+    bool Button::iconSprite( const QTransform &transform, qreal dpr, Blit &blit ) const
+    {
+        auto d = m_decoration.data();
+
+        // sprites are blitted on device pixels, which needs a plain translation
+        if( !d || transform.type() > QTransform::TxTranslate ) return false;
+
+        // sprites exist for the animation steps only
+        const int opacitySteps = m_animationFrames - 1;
+        const int opacityStep = qRound( m_opacity*opacitySteps );
+        if( !qFuzzyCompare( 1 + m_opacity, 1 + qreal( opacityStep )/opacitySteps ) ) return false;
+
+        const QPointF devicePosition( transform.map( geometry().topLeft() ) * dpr );
+        QPoint deviceOrigin( qFloor( devicePosition.x() ) - s_buttonSpriteMargin, qFloor( devicePosition.y() ) - s_buttonSpriteMargin );
+
+        // sub pixel position, rounded to the nearest phase. The last phase is the next pixel's first
+        const QPointF fraction( devicePosition - QPointF( deviceOrigin ) - QPointF( s_buttonSpriteMargin, s_buttonSpriteMargin ) );
+        int phaseX = qRound( fraction.x()*s_buttonSpritePhases );
+        int phaseY = qRound( fraction.y()*s_buttonSpritePhases );
+        if( phaseX == s_buttonSpritePhases ) { phaseX = 0; deviceOrigin.rx()++; }
+        if( phaseY == s_buttonSpritePhases ) { phaseY = 0; deviceOrigin.ry()++; }
+
+        // everything the icons depend on
+        ButtonSpriteKey key;
+        key.style = m_buttonStyle;
+        key.type = int( type() );
+        key.checked = isChecked();
+        key.hovered = m_context.hovered;
+        // with unison hovering, some styles still draw the button under the pointer differently
+        key.directlyHovered = isHovered();
+        key.pressed = isPressed();
+        key.active = m_context.active;
+        key.animating = m_animation->state() == QAbstractAnimation::Running;
+        key.opacityStep = opacityStep;
+        key.titleBarColor = m_context.titleBarColor.rgba();
+        key.fontColor = m_context.fontColor.rgba();
+        key.warningColor = d->window()->color( ColorGroup::Warning, ColorRole::Foreground ).rgba();
+        key.lightTitleBar = m_context.lightTitleBar;
+        key.animationsEnabled = m_context.animationsEnabled;
+        key.matchColorForTitleBar = m_context.matchColorForTitleBar;
+        key.systemForegroundColor = m_context.systemForegroundColor;
+        key.iconWidth = m_iconSize.width();
+        key.iconHeight = m_iconSize.height();
+        key.width = geometry().width();
+        key.height = geometry().height();
+        key.phaseX = phaseX;
+        key.phaseY = phaseY;
+        key.devicePixelRatio = dpr;
+
+        blit.position = QPointF( deviceOrigin )/dpr;
+        if( const QImage *sprite = g_buttonSprites.object( key ) )
+        {
+            blit.image = *sprite;
+            return true;
+        }
+
+        // where the button starts in the sprite, sub pixel position included
+        const QPointF phase( QPointF( phaseX, phaseY )/s_buttonSpritePhases + QPointF( s_buttonSpriteMargin, s_buttonSpriteMargin ) );
+
+        QImage image( QSize( qCeil( phase.x() + key.width*dpr ), qCeil( phase.y() + key.height*dpr ) ) + QSize( s_buttonSpriteMargin, s_buttonSpriteMargin ), QImage::Format_ARGB32_Premultiplied );
+        image.setDevicePixelRatio( dpr );
+        image.fill( Qt::transparent );
+
+        QPainter spritePainter( &image );
+        spritePainter.translate( phase/dpr - geometry().topLeft() );
+        (this->*m_drawIcon)( &spritePainter );
+        spritePainter.end();
+
+        // the cache may drop a sprite right away if it is too large, the blit keeps its own copy
+        g_buttonSprites.insert( key, new QImage( image ), qMax<qsizetype>( 1, image.sizeInBytes()/1024 ) );
+
+        blit.image = image;
+        return true;
+    }
+
     //__________________________________________________________________
     void Button::drawIconPlasma( QPainter *painter ) const
     {
@@ -292,8 +468,8 @@ namespace Breeze
 
                         // center dot
                         QColor backgroundColor( this->backgroundColor() );
-                        auto d = qobject_cast<Decoration*>( decoration() );
-                        if( !backgroundColor.isValid() && d ) backgroundColor = d->titleBarColor();
+                        auto d = m_decoration.data();
+                        if( !backgroundColor.isValid() && d ) backgroundColor = m_context.titleBarColor;
 
                         if( backgroundColor.isValid() )
                         {
@@ -417,12 +593,11 @@ namespace Breeze
         painter->scale( width/20, width/20 );
         painter->translate( 1, 1 );
 
-        auto d = qobject_cast<Decoration*>( decoration() );
 
         // render background
         QColor backgroundColor;
-        if ( isChecked() || this->hovered() || isHovered() )
-            backgroundColor = d->titleBarColor();
+        if ( isChecked() || m_context.hovered || isHovered() )
+            backgroundColor = m_context.titleBarColor;
         else
             backgroundColor = QColor();
 
@@ -443,7 +618,7 @@ namespace Breeze
               gradient.setColorAt(0.0, backgroundColor.lighter( 100 + b ));
               gradient.setColorAt(1.0, backgroundColor);
             }
-            else if ( this->hovered() ) {
+            else if ( m_context.hovered ) {
               backgroundColor = backgroundColor.darker(115);
               gradient.setColorAt(0.0, backgroundColor.lighter( 100 + 3*b ));
               gradient.setColorAt(1.0, backgroundColor);
@@ -466,7 +641,7 @@ namespace Breeze
               gradient.setColorAt(0.0, backgroundColor.lighter( 100 + b ));
               gradient.setColorAt(1.0, backgroundColor.darker ( 120 ));
             }
-            else if ( this->hovered() ) {
+            else if ( m_context.hovered ) {
               backgroundColor = backgroundColor.lighter(150);
               gradient.setColorAt(0.0, backgroundColor.lighter( 100 + b ));
               gradient.setColorAt(1.0, backgroundColor.darker ( 120 ));
@@ -477,7 +652,7 @@ namespace Breeze
         }
 
         // render mark
-        QColor foregroundColor = d->fontColor();
+        QColor foregroundColor = m_context.fontColor;
         if( foregroundColor.isValid() )
         {
             // setup painter
@@ -646,8 +821,8 @@ namespace Breeze
         painter->translate( geometry().topLeft() );
 
         const qreal width( m_iconSize.width() );
-        auto d = qobject_cast<Decoration*>( decoration() );
-        if ( d->internalSettings()->animationsEnabled() ) {
+        auto d = m_decoration.data();
+        if ( m_context.animationsEnabled ) {
           painter->scale( width/20, width/20 );
           painter->translate( 1, 1 );
         }
@@ -656,18 +831,18 @@ namespace Breeze
           painter->translate( 4, 4 );
         }
 
-        bool inactiveWindow( d && !d->window()->isActive() );
-        bool isMatchTitleBarColor( d && d->internalSettings()->matchColorForTitleBar() );
+        bool inactiveWindow( d && !m_context.active );
+        bool isMatchTitleBarColor( d && m_context.matchColorForTitleBar );
 
         QColor darkSymbolColor( ( inactiveWindow && isMatchTitleBarColor ) ? QColor(81, 102, 107) : QColor(34, 45, 50) );
         QColor lightSymbolColor( ( inactiveWindow && isMatchTitleBarColor ) ? QColor(192, 193, 194) : QColor(250, 251, 252) );
 
-        QColor titleBarColor (d->titleBarColor());
+        QColor titleBarColor (m_context.titleBarColor);
 
         // symbols color
 
         QColor symbolColor;
-        bool isSystemForegroundColor( d && d->internalSettings()->systemForegroundColor() );
+        bool isSystemForegroundColor( d && m_context.systemForegroundColor );
         if (isSystemForegroundColor)
           symbolColor = this->fontColor();
         else {
@@ -683,7 +858,7 @@ namespace Breeze
 
         QPen symbol_pen( symbolColor );
         symbol_pen.setJoinStyle( Qt::MiterJoin );
-        if ( d->internalSettings()->animationsEnabled() )
+        if ( m_context.animationsEnabled )
           symbol_pen.setWidthF( 1.7*qMax((qreal)1.0, 20/width ) );
         else
           symbol_pen.setWidthF( 9./7.*1.7*qMax((qreal)1.0, 20/width ) );
@@ -704,7 +879,7 @@ namespace Breeze
                   button_color = QColor(200, 200, 200);
                 QPen button_pen( qGray(titleBarColor.rgb()) < 69 ? button_color.lighter(115) : button_color.darker(115) );
                 button_pen.setJoinStyle( Qt::MiterJoin );
-                if ( d->internalSettings()->animationsEnabled() )
+                if ( m_context.animationsEnabled )
                   button_pen.setWidthF( PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
                 else
                   button_pen.setWidthF( 9./7.*PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
@@ -715,7 +890,7 @@ namespace Breeze
                 QPointF c(static_cast<qreal>(9), static_cast<qreal>(9));
                 painter->drawEllipse( c, r, r );
                 painter->setBrush( Qt::NoBrush );
-                if ( this->hovered() )
+                if ( m_context.hovered )
                 {
                   painter->setPen( symbol_pen );
                   // it's a cross
@@ -738,7 +913,7 @@ namespace Breeze
                   button_color = QColor(200, 200, 200);
                 QPen button_pen( qGray(titleBarColor.rgb()) < 69 ? button_color.lighter(115) : button_color.darker(115) );
                 button_pen.setJoinStyle( Qt::MiterJoin );
-                if ( d->internalSettings()->animationsEnabled() )
+                if ( m_context.animationsEnabled )
                   button_pen.setWidthF( PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
                 else
                   button_pen.setWidthF( 9./7.*PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
@@ -749,7 +924,7 @@ namespace Breeze
                 QPointF c(static_cast<qreal>(9), static_cast<qreal>(9));
                 painter->drawEllipse( c, r, r );
                 painter->setBrush( Qt::NoBrush );
-                if ( this->hovered() )
+                if ( m_context.hovered )
                 {
                   painter->setPen( Qt::NoPen );
 
@@ -795,7 +970,7 @@ namespace Breeze
                   button_color = QColor(200, 200, 200);
                 QPen button_pen( qGray(titleBarColor.rgb()) < 69 ? button_color.lighter(115) : button_color.darker(115) );
                 button_pen.setJoinStyle( Qt::MiterJoin );
-                if ( d->internalSettings()->animationsEnabled() )
+                if ( m_context.animationsEnabled )
                   button_pen.setWidthF( PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
                 else
                   button_pen.setWidthF( 9./7.*PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
@@ -806,7 +981,7 @@ namespace Breeze
                 QPointF c(static_cast<qreal>(9), static_cast<qreal>(9));
                 painter->drawEllipse( c, r, r );
                 painter->setBrush( Qt::NoBrush );
-                if ( this->hovered() )
+                if ( m_context.hovered )
                 {
                   painter->setPen( symbol_pen );
                   painter->drawLine( QPointF( 5, 9 ), QPointF( 13, 9 ) );
@@ -825,7 +1000,7 @@ namespace Breeze
                   button_color = QColor(200, 200, 200);
                 QPen button_pen( qGray(titleBarColor.rgb()) < 69 ? button_color.lighter(115) : button_color.darker(115) );
                 button_pen.setJoinStyle( Qt::MiterJoin );
-                if ( d->internalSettings()->animationsEnabled() )
+                if ( m_context.animationsEnabled )
                   button_pen.setWidthF( PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
                 else
                   button_pen.setWidthF( 9./7.*PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
@@ -837,7 +1012,7 @@ namespace Breeze
                 painter->drawEllipse( c, r, r );
                 painter->setBrush( Qt::NoBrush );
 
-                if ( this->hovered() || isChecked() )
+                if ( m_context.hovered || isChecked() )
                 {
                   painter->setPen( Qt::NoPen );
                   painter->setBrush(QBrush(symbolColor));
@@ -857,7 +1032,7 @@ namespace Breeze
                   button_color = QColor(200, 200, 200);
                 QPen button_pen( qGray(titleBarColor.rgb()) < 69 ? button_color.lighter(115) : button_color.darker(115) );
                 button_pen.setJoinStyle( Qt::MiterJoin );
-                if ( d->internalSettings()->animationsEnabled() )
+                if ( m_context.animationsEnabled )
                   button_pen.setWidthF( PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
                 else
                   button_pen.setWidthF( 9./7.*PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
@@ -881,7 +1056,7 @@ namespace Breeze
                     painter->fillPath(path, QBrush(symbolColor));
 
                 }
-                else if ( this->hovered() ) {
+                else if ( m_context.hovered ) {
                     painter->setPen( symbol_pen );
                     painter->drawLine( QPointF( 6, 6 ), QPointF( 12, 6 ) );
                     painter->setPen( Qt::NoPen );
@@ -906,7 +1081,7 @@ namespace Breeze
                   button_color = QColor(200, 200, 200);
                 QPen button_pen( qGray(titleBarColor.rgb()) < 69 ? button_color.lighter(115) : button_color.darker(115) );
                 button_pen.setJoinStyle( Qt::MiterJoin );
-                if ( d->internalSettings()->animationsEnabled() )
+                if ( m_context.animationsEnabled )
                   button_pen.setWidthF( PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
                 else
                   button_pen.setWidthF( 9./7.*PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
@@ -918,7 +1093,7 @@ namespace Breeze
                 painter->drawEllipse( c, r, r );
                 painter->setBrush( Qt::NoBrush );
 
-                if ( this->hovered() || isChecked() )
+                if ( m_context.hovered || isChecked() )
                 {
                   painter->setPen( Qt::NoPen );
 
@@ -943,7 +1118,7 @@ namespace Breeze
                   button_color = QColor(200, 200, 200);
                 QPen button_pen( qGray(titleBarColor.rgb()) < 69 ? button_color.lighter(115) : button_color.darker(115) );
                 button_pen.setJoinStyle( Qt::MiterJoin );
-                if ( d->internalSettings()->animationsEnabled() )
+                if ( m_context.animationsEnabled )
                   button_pen.setWidthF( PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
                 else
                   button_pen.setWidthF( 9./7.*PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
@@ -955,7 +1130,7 @@ namespace Breeze
                 painter->drawEllipse( c, r, r );
                 painter->setBrush( Qt::NoBrush );
 
-                if ( this->hovered() || isChecked() )
+                if ( m_context.hovered || isChecked() )
                 {
                   painter->setPen( Qt::NoPen );
 
@@ -971,7 +1146,7 @@ namespace Breeze
             case DecorationButtonType::ApplicationMenu:
             {
                 QColor menuSymbolColor;
-                bool isSystemForegroundColor( d && d->internalSettings()->systemForegroundColor() );
+                bool isSystemForegroundColor( d && m_context.systemForegroundColor );
                 if (isSystemForegroundColor)
                   menuSymbolColor = this->fontColor();
                 else {
@@ -1012,7 +1187,7 @@ namespace Breeze
                   button_color = QColor(200, 200, 200);
                 QPen button_pen( qGray(titleBarColor.rgb()) < 69 ? button_color.lighter(115) : button_color.darker(115) );
                 button_pen.setJoinStyle( Qt::MiterJoin );
-                if ( d->internalSettings()->animationsEnabled() )
+                if ( m_context.animationsEnabled )
                   button_pen.setWidthF( PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
                 else
                   button_pen.setWidthF( 9./7.*PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
@@ -1024,7 +1199,7 @@ namespace Breeze
                 painter->drawEllipse( c, r, r );
                 painter->setBrush( Qt::NoBrush );
 
-                if ( this->hovered() || isChecked() )
+                if ( m_context.hovered || isChecked() )
                 {
                   painter->setPen( symbol_pen );
                   QPainterPath path;
@@ -1055,8 +1230,8 @@ namespace Breeze
         painter->translate( geometry().topLeft() );
 
         const qreal width( m_iconSize.width() );
-        auto d = qobject_cast<Decoration*>( decoration() );
-        if ( d->internalSettings()->animationsEnabled() ) {
+        auto d = m_decoration.data();
+        if ( m_context.animationsEnabled ) {
           painter->scale( width/20, width/20 );
           painter->translate( 1, 1 );
         }
@@ -1065,18 +1240,18 @@ namespace Breeze
           painter->translate( 4, 4 );
         }
 
-        bool inactiveWindow( d && !d->window()->isActive() );
-        bool isMatchTitleBarColor( d && d->internalSettings()->matchColorForTitleBar() );
+        bool inactiveWindow( d && !m_context.active );
+        bool isMatchTitleBarColor( d && m_context.matchColorForTitleBar );
 
         QColor darkSymbolColor( ( inactiveWindow && isMatchTitleBarColor ) ? QColor(81, 102, 107) : QColor(34, 45, 50) );
         QColor lightSymbolColor( ( inactiveWindow && isMatchTitleBarColor ) ? QColor(192, 193, 194) : QColor(250, 251, 252) );
 
-        QColor titleBarColor (d->titleBarColor());
+        QColor titleBarColor (m_context.titleBarColor);
 
         // symbols color
 
         QColor symbolColor;
-        bool isSystemForegroundColor( d && d->internalSettings()->systemForegroundColor() );
+        bool isSystemForegroundColor( d && m_context.systemForegroundColor );
         if (isSystemForegroundColor)
           symbolColor = this->fontColor();
         else {
@@ -1092,7 +1267,7 @@ namespace Breeze
 
         QPen symbol_pen( symbolColor );
         symbol_pen.setJoinStyle( Qt::MiterJoin );
-        if ( d->internalSettings()->animationsEnabled() )
+        if ( m_context.animationsEnabled )
           symbol_pen.setWidthF( 1.2*qMax((qreal)1.0, 20/width ) );
         else
           symbol_pen.setWidthF( 9./7.*1.2*qMax((qreal)1.0, 20/width ) );
@@ -1113,7 +1288,7 @@ namespace Breeze
                   button_color = QColor(200, 200, 200);
                 QPen button_pen( qGray(titleBarColor.rgb()) < 69 ? button_color.lighter(115) : button_color.darker(115) );
                 button_pen.setJoinStyle( Qt::MiterJoin );
-                if ( d->internalSettings()->animationsEnabled() )
+                if ( m_context.animationsEnabled )
                   button_pen.setWidthF( PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
                 else
                   button_pen.setWidthF( 9./7.*PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
@@ -1124,7 +1299,7 @@ namespace Breeze
                 QPointF c(static_cast<qreal>(9), static_cast<qreal>(9));
                 painter->drawEllipse( c, r, r );
                 painter->setBrush( Qt::NoBrush );
-                if ( this->hovered() )
+                if ( m_context.hovered )
                 {
                   painter->setPen( symbol_pen );
                   // it's a cross
@@ -1147,7 +1322,7 @@ namespace Breeze
                   button_color = QColor(200, 200, 200);
                 QPen button_pen( qGray(titleBarColor.rgb()) < 69 ? button_color.lighter(115) : button_color.darker(115) );
                 button_pen.setJoinStyle( Qt::MiterJoin );
-                if ( d->internalSettings()->animationsEnabled() )
+                if ( m_context.animationsEnabled )
                   button_pen.setWidthF( PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
                 else
                   button_pen.setWidthF( 9./7.*PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
@@ -1158,7 +1333,7 @@ namespace Breeze
                 QPointF c(static_cast<qreal>(9), static_cast<qreal>(9));
                 painter->drawEllipse( c, r, r );
                 painter->setBrush( Qt::NoBrush );
-                if ( this->hovered() )
+                if ( m_context.hovered )
                 {
 
                   painter->setPen( symbol_pen );
@@ -1196,7 +1371,7 @@ namespace Breeze
                   button_color = QColor(200, 200, 200);
                 QPen button_pen( qGray(titleBarColor.rgb()) < 69 ? button_color.lighter(115) : button_color.darker(115) );
                 button_pen.setJoinStyle( Qt::MiterJoin );
-                if ( d->internalSettings()->animationsEnabled() )
+                if ( m_context.animationsEnabled )
                   button_pen.setWidthF( PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
                 else
                   button_pen.setWidthF( 9./7.*PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
@@ -1208,7 +1383,7 @@ namespace Breeze
                 painter->drawEllipse( c, r, r );
                 painter->setBrush( Qt::NoBrush );
 
-                if ( this->hovered() )
+                if ( m_context.hovered )
                 {
                   painter->setPen( symbol_pen );
                   painter->drawLine( QPointF( 5, 9 ), QPointF( 13, 9 ) );
@@ -1227,7 +1402,7 @@ namespace Breeze
                   button_color = QColor(200, 200, 200);
                 QPen button_pen( qGray(titleBarColor.rgb()) < 69 ? button_color.lighter(115) : button_color.darker(115) );
                 button_pen.setJoinStyle( Qt::MiterJoin );
-                if ( d->internalSettings()->animationsEnabled() )
+                if ( m_context.animationsEnabled )
                   button_pen.setWidthF( PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
                 else
                   button_pen.setWidthF( 9./7.*PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
@@ -1239,11 +1414,11 @@ namespace Breeze
                 painter->drawEllipse( c, r, r );
                 painter->setBrush( Qt::NoBrush );
 
-                if ( this->hovered() && !isChecked() )
+                if ( m_context.hovered && !isChecked() )
                 {
                   painter->setPen( symbol_pen );
 
-                  if ( !isHovered() && d->internalSettings()->animationsEnabled() ) {
+                  if ( !isHovered() && m_context.animationsEnabled ) {
                     painter->drawLine( QPointF( 5, 5 ), QPointF( 13, 5 ) );
                     painter->drawLine( QPointF( 13, 5 ), QPointF( 13, 13 ) );
                     painter->drawLine( QPointF( 5, 5 ), QPointF( 5, 13 ) );
@@ -1292,7 +1467,7 @@ namespace Breeze
                   button_color = QColor(200, 200, 200);
                 QPen button_pen( qGray(titleBarColor.rgb()) < 69 ? button_color.lighter(115) : button_color.darker(115) );
                 button_pen.setJoinStyle( Qt::MiterJoin );
-                if ( d->internalSettings()->animationsEnabled() )
+                if ( m_context.animationsEnabled )
                   button_pen.setWidthF( PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
                 else
                   button_pen.setWidthF( 9./7.*PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
@@ -1312,7 +1487,7 @@ namespace Breeze
                   painter->setBrush(QBrush(symbolColor));
                   painter->drawEllipse( QRectF( 8, 6, 2, 2 ) );
                 }
-                else if ( this->hovered() )
+                else if ( m_context.hovered )
                 {
                   painter->setPen( symbol_pen );
                   painter->drawLine( QPointF( 4, 6 ), QPointF( 14, 6 ) );
@@ -1335,7 +1510,7 @@ namespace Breeze
                   button_color = QColor(200, 200, 200);
                 QPen button_pen( qGray(titleBarColor.rgb()) < 69 ? button_color.lighter(115) : button_color.darker(115) );
                 button_pen.setJoinStyle( Qt::MiterJoin );
-                if ( d->internalSettings()->animationsEnabled() )
+                if ( m_context.animationsEnabled )
                   button_pen.setWidthF( PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
                 else
                   button_pen.setWidthF( 9./7.*PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
@@ -1347,7 +1522,7 @@ namespace Breeze
                 painter->drawEllipse( c, r, r );
                 painter->setBrush( Qt::NoBrush );
 
-                if ( this->hovered() || isChecked() )
+                if ( m_context.hovered || isChecked() )
                 {
                   painter->setPen( symbol_pen );
                   painter->drawPolyline( QVector<QPointF>{
@@ -1370,7 +1545,7 @@ namespace Breeze
                   button_color = QColor(200, 200, 200);
                 QPen button_pen( qGray(titleBarColor.rgb()) < 69 ? button_color.lighter(115) : button_color.darker(115) );
                 button_pen.setJoinStyle( Qt::MiterJoin );
-                if ( d->internalSettings()->animationsEnabled() )
+                if ( m_context.animationsEnabled )
                   button_pen.setWidthF( PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
                 else
                   button_pen.setWidthF( 9./7.*PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
@@ -1382,7 +1557,7 @@ namespace Breeze
                 painter->drawEllipse( c, r, r );
                 painter->setBrush( Qt::NoBrush );
 
-                if ( this->hovered() || isChecked() )
+                if ( m_context.hovered || isChecked() )
                 {
                   painter->setPen( symbol_pen );
                   painter->drawPolyline( QVector<QPointF>{
@@ -1396,7 +1571,7 @@ namespace Breeze
             case DecorationButtonType::ApplicationMenu:
             {
                 QColor menuSymbolColor;
-                bool isSystemForegroundColor( d && d->internalSettings()->systemForegroundColor() );
+                bool isSystemForegroundColor( d && m_context.systemForegroundColor );
                 if (isSystemForegroundColor)
                   menuSymbolColor = this->fontColor();
                 else {
@@ -1437,7 +1612,7 @@ namespace Breeze
                   button_color = QColor(200, 200, 200);
                 QPen button_pen( qGray(titleBarColor.rgb()) < 69 ? button_color.lighter(115) : button_color.darker(115) );
                 button_pen.setJoinStyle( Qt::MiterJoin );
-                if ( d->internalSettings()->animationsEnabled() )
+                if ( m_context.animationsEnabled )
                   button_pen.setWidthF( PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
                 else
                   button_pen.setWidthF( 9./7.*PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
@@ -1449,7 +1624,7 @@ namespace Breeze
                 painter->drawEllipse( c, r, r );
                 painter->setBrush( Qt::NoBrush );
 
-                if ( this->hovered() || isChecked() )
+                if ( m_context.hovered || isChecked() )
                 {
                   painter->setPen( symbol_pen );
                   int startAngle = 260 * 16;
@@ -1482,8 +1657,8 @@ namespace Breeze
         painter->translate( geometry().topLeft() );
 
         const qreal width( m_iconSize.width() );
-        auto d = qobject_cast<Decoration*>( decoration() );
-        if ( d->internalSettings()->animationsEnabled() ) {
+        auto d = m_decoration.data();
+        if ( m_context.animationsEnabled ) {
           painter->scale( width/20, width/20 );
           painter->translate( 1, 1 );
         }
@@ -1492,20 +1667,20 @@ namespace Breeze
           painter->translate( 4, 4 );
         }
 
-        bool inactiveWindow( d && !d->window()->isActive() );
-        bool useActiveButtonStyle( d && d->internalSettings()->buttonStyle() == 5 );
-        bool useInactiveButtonStyle( d && d->internalSettings()->buttonStyle() == 6 );
-        bool isMatchTitleBarColor( d && d->internalSettings()->matchColorForTitleBar() );
+        bool inactiveWindow( d && !m_context.active );
+        bool useActiveButtonStyle( d && m_buttonStyle == 5 );
+        bool useInactiveButtonStyle( d && m_buttonStyle == 6 );
+        bool isMatchTitleBarColor( d && m_context.matchColorForTitleBar );
 
         QColor darkSymbolColor( ( inactiveWindow && isMatchTitleBarColor ) ? QColor(81, 102, 107) : QColor(34, 45, 50) );
         QColor lightSymbolColor( ( inactiveWindow && isMatchTitleBarColor ) ? QColor(192, 193, 194) : QColor(250, 251, 252) );
 
-        QColor titleBarColor (d->titleBarColor());
+        QColor titleBarColor (m_context.titleBarColor);
 
         // symbols color
 
         QColor symbolColor;
-        bool isSystemForegroundColor( d && d->internalSettings()->systemForegroundColor() );
+        bool isSystemForegroundColor( d && m_context.systemForegroundColor );
         if (isSystemForegroundColor)
           symbolColor = this->fontColor();
         else
@@ -1515,7 +1690,7 @@ namespace Breeze
 
         QPen symbol_pen( symbolColor );
         symbol_pen.setJoinStyle( Qt::MiterJoin );
-        if ( d->internalSettings()->animationsEnabled() )
+        if ( m_context.animationsEnabled )
           symbol_pen.setWidthF( 1.7*qMax((qreal)1.0, 20/width ) );
         else
           symbol_pen.setWidthF( 9./7.*1.7*qMax((qreal)1.0, 20/width ) );
@@ -1532,12 +1707,12 @@ namespace Breeze
                   button_color = QColor(255, 94, 88);
                 QPen button_pen( qGray(titleBarColor.rgb()) < 69 ? button_color.lighter(115) : button_color.darker(115) );
                 button_pen.setJoinStyle( Qt::MiterJoin );
-                if ( d->internalSettings()->animationsEnabled() )
+                if ( m_context.animationsEnabled )
                   button_pen.setWidthF( PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
                 else
                   button_pen.setWidthF( 9./7.*PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
 
-                if ( ( ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle ) && this->hovered() )
+                if ( ( ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle ) && m_context.hovered )
                 {
                   // ring
                   painter->setBrush( Qt::NoBrush );
@@ -1559,7 +1734,7 @@ namespace Breeze
                 QPointF c(static_cast<qreal>(9), static_cast<qreal>(9));
                 painter->drawEllipse( c, r, r );
                 painter->setBrush( Qt::NoBrush );
-                if ( this->hovered() || ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle )
+                if ( m_context.hovered || ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle )
                 {
                   painter->setPen( symbol_pen );
                   // it's a cross
@@ -1578,12 +1753,12 @@ namespace Breeze
                   button_color = QColor(40, 200, 64);
                 QPen button_pen( qGray(titleBarColor.rgb()) < 69 ? button_color.lighter(115) : button_color.darker(115) );
                 button_pen.setJoinStyle( Qt::MiterJoin );
-                if ( d->internalSettings()->animationsEnabled() )
+                if ( m_context.animationsEnabled )
                   button_pen.setWidthF( PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
                 else
                   button_pen.setWidthF( 9./7.*PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
 
-                if ( ( ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle ) && this->hovered() )
+                if ( ( ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle ) && m_context.hovered )
                 {
                   // ring
                   painter->setBrush( Qt::NoBrush );
@@ -1606,7 +1781,7 @@ namespace Breeze
                 painter->drawEllipse( c, r, r );
                 painter->setBrush( Qt::NoBrush );
 
-                if ( this->hovered() || ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle )
+                if ( m_context.hovered || ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle )
                 {
                   painter->setPen( Qt::NoPen );
 
@@ -1648,12 +1823,12 @@ namespace Breeze
                   button_color = QColor(255, 188, 48);
                 QPen button_pen( qGray(titleBarColor.rgb()) < 69 ? button_color.lighter(115) : button_color.darker(115) );
                 button_pen.setJoinStyle( Qt::MiterJoin );
-                if ( d->internalSettings()->animationsEnabled() )
+                if ( m_context.animationsEnabled )
                   button_pen.setWidthF( PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
                 else
                   button_pen.setWidthF( 9./7.*PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
 
-                if ( ( ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle ) && this->hovered() )
+                if ( ( ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle ) && m_context.hovered )
                 {
                   // ring
                   painter->setBrush( Qt::NoBrush );
@@ -1675,7 +1850,7 @@ namespace Breeze
                 QPointF c(static_cast<qreal>(9), static_cast<qreal>(9));
                 painter->drawEllipse( c, r, r );
                 painter->setBrush( Qt::NoBrush );
-                if ( this->hovered() || ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle )
+                if ( m_context.hovered || ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle )
                 {
                   painter->setPen( symbol_pen );
                   painter->drawLine( QPointF( 5, 9 ), QPointF( 13, 9 ) );
@@ -1688,12 +1863,12 @@ namespace Breeze
                 QColor button_color = QColor(125, 209, 200);
                 QPen button_pen( qGray(titleBarColor.rgb()) < 69 ? button_color.lighter(115) : button_color.darker(115) );
                 button_pen.setJoinStyle( Qt::MiterJoin );
-                if ( d->internalSettings()->animationsEnabled() )
+                if ( m_context.animationsEnabled )
                   button_pen.setWidthF( PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
                 else
                   button_pen.setWidthF( 9./7.*PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
 
-                if ( ( ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle ) && ( this->hovered() || isChecked() ) )
+                if ( ( ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle ) && ( m_context.hovered || isChecked() ) )
                 {
                   // ring
                   painter->setBrush( Qt::NoBrush );
@@ -1717,7 +1892,7 @@ namespace Breeze
                 painter->drawEllipse( c, r, r );
                 painter->setBrush( Qt::NoBrush );
 
-                if ( this->hovered() || isChecked() ||  ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle )
+                if ( m_context.hovered || isChecked() ||  ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle )
                 {
                   painter->setPen( Qt::NoPen );
                   painter->setBrush(QBrush(symbolColor));
@@ -1731,12 +1906,12 @@ namespace Breeze
                 QColor button_color = QColor(204, 176, 213);
                 QPen button_pen( qGray(titleBarColor.rgb()) < 69 ? button_color.lighter(115) : button_color.darker(115) );
                 button_pen.setJoinStyle( Qt::MiterJoin );
-                if ( d->internalSettings()->animationsEnabled() )
+                if ( m_context.animationsEnabled )
                   button_pen.setWidthF( PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
                 else
                   button_pen.setWidthF( 9./7.*PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
 
-                if ( ( ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle ) && ( this->hovered() || isChecked() ) )
+                if ( ( ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle ) && ( m_context.hovered || isChecked() ) )
                 {
                   // ring
                   painter->setBrush( Qt::NoBrush );
@@ -1772,7 +1947,7 @@ namespace Breeze
                     painter->fillPath(path, QBrush(symbolColor));
 
                 }
-                else if ( this->hovered() || ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle ) {
+                else if ( m_context.hovered || ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle ) {
                     painter->setPen( symbol_pen );
                     painter->drawLine( QPointF( 6, 6 ), QPointF( 12, 6 ) );
                     painter->setPen( Qt::NoPen );
@@ -1791,12 +1966,12 @@ namespace Breeze
                 QColor button_color = QColor(255, 137, 241);
                 QPen button_pen( qGray(titleBarColor.rgb()) < 69 ? button_color.lighter(115) : button_color.darker(115) );
                 button_pen.setJoinStyle( Qt::MiterJoin );
-                if ( d->internalSettings()->animationsEnabled() )
+                if ( m_context.animationsEnabled )
                   button_pen.setWidthF( PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
                 else
                   button_pen.setWidthF( 9./7.*PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
 
-                if ( ( ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle ) && ( this->hovered() || isChecked() ) )
+                if ( ( ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle ) && ( m_context.hovered || isChecked() ) )
                 {
                   // ring
                   painter->setBrush( Qt::NoBrush );
@@ -1820,7 +1995,7 @@ namespace Breeze
                 painter->drawEllipse( c, r, r );
                 painter->setBrush( Qt::NoBrush );
 
-                if ( this->hovered() || isChecked() ||  ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle )
+                if ( m_context.hovered || isChecked() ||  ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle )
                 {
                   painter->setPen( Qt::NoPen );
 
@@ -1839,12 +2014,12 @@ namespace Breeze
                 QColor button_color = QColor(135, 206, 249);
                 QPen button_pen( qGray(titleBarColor.rgb()) < 69 ? button_color.lighter(115) : button_color.darker(115) );
                 button_pen.setJoinStyle( Qt::MiterJoin );
-                if ( d->internalSettings()->animationsEnabled() )
+                if ( m_context.animationsEnabled )
                   button_pen.setWidthF( PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
                 else
                   button_pen.setWidthF( 9./7.*PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
 
-                if ( ( ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle ) && ( this->hovered() || isChecked() ) )
+                if ( ( ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle ) && ( m_context.hovered || isChecked() ) )
                 {
                   // ring
                   painter->setBrush( Qt::NoBrush );
@@ -1868,7 +2043,7 @@ namespace Breeze
                 painter->drawEllipse( c, r, r );
                 painter->setBrush( Qt::NoBrush );
 
-                if ( this->hovered() || isChecked() ||  ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle )
+                if ( m_context.hovered || isChecked() ||  ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle )
                 {
                   painter->setPen( Qt::NoPen );
 
@@ -1884,7 +2059,7 @@ namespace Breeze
             case DecorationButtonType::ApplicationMenu:
             {
                 QColor menuSymbolColor;
-                bool isSystemForegroundColor( d && d->internalSettings()->systemForegroundColor() );
+                bool isSystemForegroundColor( d && m_context.systemForegroundColor );
                 if (isSystemForegroundColor)
                   menuSymbolColor = this->fontColor();
                 else {
@@ -1919,12 +2094,12 @@ namespace Breeze
                 QColor button_color = QColor(102, 156, 246);
                 QPen button_pen( qGray(titleBarColor.rgb()) < 69 ? button_color.lighter(115) : button_color.darker(115) );
                 button_pen.setJoinStyle( Qt::MiterJoin );
-                if ( d->internalSettings()->animationsEnabled() )
+                if ( m_context.animationsEnabled )
                   button_pen.setWidthF( PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
                 else
                   button_pen.setWidthF( 9./7.*PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
 
-                if ( ( ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle ) && ( this->hovered() || isChecked() ) )
+                if ( ( ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle ) && ( m_context.hovered || isChecked() ) )
                 {
                   // ring
                   painter->setBrush( Qt::NoBrush );
@@ -1948,7 +2123,7 @@ namespace Breeze
                 painter->drawEllipse( c, r, r );
                 painter->setBrush( Qt::NoBrush );
 
-                if ( this->hovered() || isChecked() || ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle )
+                if ( m_context.hovered || isChecked() || ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle )
                 {
                   painter->setPen( symbol_pen );
                   QPainterPath path;
@@ -1979,8 +2154,8 @@ namespace Breeze
         painter->translate( geometry().topLeft() );
 
         const qreal width( m_iconSize.width() );
-        auto d = qobject_cast<Decoration*>( decoration() );
-        if ( d->internalSettings()->animationsEnabled() ) {
+        auto d = m_decoration.data();
+        if ( m_context.animationsEnabled ) {
           painter->scale( width/20, width/20 );
           painter->translate( 1, 1 );
         }
@@ -1989,20 +2164,20 @@ namespace Breeze
           painter->translate( 4, 4 );
         }
 
-        bool inactiveWindow( d && !d->window()->isActive() );
-        bool useActiveButtonStyle( d && d->internalSettings()->buttonStyle() == 8 );
-        bool useInactiveButtonStyle( d && d->internalSettings()->buttonStyle() == 9 );
-        bool isMatchTitleBarColor( d && d->internalSettings()->matchColorForTitleBar() );
+        bool inactiveWindow( d && !m_context.active );
+        bool useActiveButtonStyle( d && m_buttonStyle == 8 );
+        bool useInactiveButtonStyle( d && m_buttonStyle == 9 );
+        bool isMatchTitleBarColor( d && m_context.matchColorForTitleBar );
 
         QColor darkSymbolColor( ( inactiveWindow && isMatchTitleBarColor ) ? QColor(81, 102, 107) : QColor(34, 45, 50) );
         QColor lightSymbolColor( ( inactiveWindow && isMatchTitleBarColor ) ? QColor(192, 193, 194) : QColor(250, 251, 252) );
 
-        QColor titleBarColor (d->titleBarColor());
+        QColor titleBarColor (m_context.titleBarColor);
 
         // symbols color
 
         QColor symbolColor;
-        bool isSystemForegroundColor( d && d->internalSettings()->systemForegroundColor() );
+        bool isSystemForegroundColor( d && m_context.systemForegroundColor );
         if (isSystemForegroundColor)
           symbolColor = this->fontColor();
         else
@@ -2012,7 +2187,7 @@ namespace Breeze
 
         QPen symbol_pen( symbolColor );
         symbol_pen.setJoinStyle( Qt::MiterJoin );
-        if ( d->internalSettings()->animationsEnabled() )
+        if ( m_context.animationsEnabled )
           symbol_pen.setWidthF( 1.2*qMax((qreal)1.0, 20/width ) );
         else
           symbol_pen.setWidthF( 9./7.*1.2*qMax((qreal)1.0, 20/width ) );
@@ -2029,12 +2204,12 @@ namespace Breeze
                   button_color = QColor(255, 94, 88);
                 QPen button_pen( qGray(titleBarColor.rgb()) < 69 ? button_color.lighter(115) : button_color.darker(115) );
                 button_pen.setJoinStyle( Qt::MiterJoin );
-                if ( d->internalSettings()->animationsEnabled() )
+                if ( m_context.animationsEnabled )
                   button_pen.setWidthF( PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
                 else
                   button_pen.setWidthF( 9./7.*PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
 
-                if ( ( ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle ) && this->hovered() )
+                if ( ( ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle ) && m_context.hovered )
                 {
                   // ring
                   painter->setBrush( Qt::NoBrush );
@@ -2056,7 +2231,7 @@ namespace Breeze
                 QPointF c(static_cast<qreal>(9), static_cast<qreal>(9));
                 painter->drawEllipse( c, r, r );
                 painter->setBrush( Qt::NoBrush );
-                if ( this->hovered() || ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle )
+                if ( m_context.hovered || ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle )
                 {
                   painter->setPen( symbol_pen );
                   // it's a cross
@@ -2075,12 +2250,12 @@ namespace Breeze
                   button_color = QColor(40, 200, 64);
                 QPen button_pen( qGray(titleBarColor.rgb()) < 69 ? button_color.lighter(115) : button_color.darker(115) );
                 button_pen.setJoinStyle( Qt::MiterJoin );
-                if ( d->internalSettings()->animationsEnabled() )
+                if ( m_context.animationsEnabled )
                   button_pen.setWidthF( PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
                 else
                   button_pen.setWidthF( 9./7.*PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
 
-                if ( ( ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle ) && this->hovered() )
+                if ( ( ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle ) && m_context.hovered )
                 {
                   // ring
                   painter->setBrush( Qt::NoBrush );
@@ -2102,7 +2277,7 @@ namespace Breeze
                 QPointF c(static_cast<qreal>(9), static_cast<qreal>(9));
                 painter->drawEllipse( c, r, r );
                 painter->setBrush( Qt::NoBrush );
-                if ( this->hovered() || ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle )
+                if ( m_context.hovered || ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle )
                 {
 
                   painter->setPen( symbol_pen );
@@ -2136,12 +2311,12 @@ namespace Breeze
                   button_color = QColor(255, 188, 48);
                 QPen button_pen( qGray(titleBarColor.rgb()) < 69 ? button_color.lighter(115) : button_color.darker(115) );
                 button_pen.setJoinStyle( Qt::MiterJoin );
-                if ( d->internalSettings()->animationsEnabled() )
+                if ( m_context.animationsEnabled )
                   button_pen.setWidthF( PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
                 else
                   button_pen.setWidthF( 9./7.*PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
 
-                if ( ( ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle ) && this->hovered() )
+                if ( ( ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle ) && m_context.hovered )
                 {
                   // ring
                   painter->setBrush( Qt::NoBrush );
@@ -2165,7 +2340,7 @@ namespace Breeze
                 painter->drawEllipse( c, r, r );
                 painter->setBrush( Qt::NoBrush );
 
-                if ( this->hovered() || ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle )
+                if ( m_context.hovered || ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle )
                 {
                   painter->setPen( symbol_pen );
                   painter->drawLine( QPointF( 5, 9 ), QPointF( 13, 9 ) );
@@ -2178,12 +2353,12 @@ namespace Breeze
                 QColor button_color = QColor(125, 209, 200);
                 QPen button_pen( qGray(titleBarColor.rgb()) < 69 ? button_color.lighter(115) : button_color.darker(115) );
                 button_pen.setJoinStyle( Qt::MiterJoin );
-                if ( d->internalSettings()->animationsEnabled() )
+                if ( m_context.animationsEnabled )
                   button_pen.setWidthF( PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
                 else
                   button_pen.setWidthF( 9./7.*PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
 
-                if ( ( ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle ) && ( this->hovered() || isChecked() ) )
+                if ( ( ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle ) && ( m_context.hovered || isChecked() ) )
                 {
                   // ring
                   painter->setBrush( Qt::NoBrush );
@@ -2207,11 +2382,11 @@ namespace Breeze
                 painter->drawEllipse( c, r, r );
                 painter->setBrush( Qt::NoBrush );
 
-                if ( !isChecked() && ( this->hovered() || ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle ) )
+                if ( !isChecked() && ( m_context.hovered || ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle ) )
                 {
                   painter->setPen( symbol_pen );
 
-                  if ( !isHovered() && d->internalSettings()->animationsEnabled() ) {
+                  if ( !isHovered() && m_context.animationsEnabled ) {
                     painter->drawLine( QPointF( 5, 5 ), QPointF( 13, 5 ) );
                     painter->drawLine( QPointF( 13, 5 ), QPointF( 13, 13 ) );
                     painter->drawLine( QPointF( 5, 5 ), QPointF( 5, 13 ) );
@@ -2231,7 +2406,7 @@ namespace Breeze
                     painter->drawLine( QPointF( 3, 13 ), QPointF( 4.5, 13 ) );
                   }
                 }
-                else if ( isChecked() && ( this->hovered() || ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle ) )
+                else if ( isChecked() && ( m_context.hovered || ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle ) )
                 {
                   painter->setPen( symbol_pen );
 
@@ -2253,12 +2428,12 @@ namespace Breeze
                 QColor button_color = QColor(204, 176, 213);
                 QPen button_pen( qGray(titleBarColor.rgb()) < 69 ? button_color.lighter(115) : button_color.darker(115) );
                 button_pen.setJoinStyle( Qt::MiterJoin );
-                if ( d->internalSettings()->animationsEnabled() )
+                if ( m_context.animationsEnabled )
                   button_pen.setWidthF( PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
                 else
                   button_pen.setWidthF( 9./7.*PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
 
-                if ( ( ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle ) && ( this->hovered() || isChecked() ) )
+                if ( ( ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle ) && ( m_context.hovered || isChecked() ) )
                 {
                   // ring
                   painter->setBrush( Qt::NoBrush );
@@ -2290,7 +2465,7 @@ namespace Breeze
                   painter->setBrush(QBrush(symbolColor));
                   painter->drawEllipse( QRectF( 8, 6, 2, 2 ) );
                 }
-                else if ( this->hovered() || ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle )
+                else if ( m_context.hovered || ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle )
                 {
                   painter->setPen( symbol_pen );
                   painter->drawLine( QPointF( 4, 6 ), QPointF( 14, 6 ) );
@@ -2307,12 +2482,12 @@ namespace Breeze
                 QColor button_color = QColor(255, 137, 241);
                 QPen button_pen( qGray(titleBarColor.rgb()) < 69 ? button_color.lighter(115) : button_color.darker(115) );
                 button_pen.setJoinStyle( Qt::MiterJoin );
-                if ( d->internalSettings()->animationsEnabled() )
+                if ( m_context.animationsEnabled )
                   button_pen.setWidthF( PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
                 else
                   button_pen.setWidthF( 9./7.*PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
 
-                if ( ( ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle ) && ( this->hovered() || isChecked() ) )
+                if ( ( ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle ) && ( m_context.hovered || isChecked() ) )
                 {
                   // ring
                   painter->setBrush( Qt::NoBrush );
@@ -2336,7 +2511,7 @@ namespace Breeze
                 painter->drawEllipse( c, r, r );
                 painter->setBrush( Qt::NoBrush );
 
-                if ( this->hovered() || isChecked() ||  ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle )
+                if ( m_context.hovered || isChecked() ||  ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle )
                 {
                   painter->setPen( symbol_pen );
                   painter->drawPolyline( QVector<QPointF>{
@@ -2353,12 +2528,12 @@ namespace Breeze
                 QColor button_color = QColor(135, 206, 249);
                 QPen button_pen( qGray(titleBarColor.rgb()) < 69 ? button_color.lighter(115) : button_color.darker(115) );
                 button_pen.setJoinStyle( Qt::MiterJoin );
-                if ( d->internalSettings()->animationsEnabled() )
+                if ( m_context.animationsEnabled )
                   button_pen.setWidthF( PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
                 else
                   button_pen.setWidthF( 9./7.*PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
 
-                if ( ( ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle ) && ( this->hovered() || isChecked() ) )
+                if ( ( ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle ) && ( m_context.hovered || isChecked() ) )
                 {
                   // ring
                   painter->setBrush( Qt::NoBrush );
@@ -2382,7 +2557,7 @@ namespace Breeze
                 painter->drawEllipse( c, r, r );
                 painter->setBrush( Qt::NoBrush );
 
-                if ( this->hovered() || isChecked() ||  ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle )
+                if ( m_context.hovered || isChecked() ||  ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle )
                 {
                   painter->setPen( symbol_pen );
                   painter->drawPolyline( QVector<QPointF>{
@@ -2396,7 +2571,7 @@ namespace Breeze
             case DecorationButtonType::ApplicationMenu:
             {
                 QColor menuSymbolColor;
-                bool isSystemForegroundColor( d && d->internalSettings()->systemForegroundColor() );
+                bool isSystemForegroundColor( d && m_context.systemForegroundColor );
                 if (isSystemForegroundColor)
                   menuSymbolColor = this->fontColor();
                 else {
@@ -2431,12 +2606,12 @@ namespace Breeze
                 QColor button_color = QColor(102, 156, 246);
                 QPen button_pen( qGray(titleBarColor.rgb()) < 69 ? button_color.lighter(115) : button_color.darker(115) );
                 button_pen.setJoinStyle( Qt::MiterJoin );
-                if ( d->internalSettings()->animationsEnabled() )
+                if ( m_context.animationsEnabled )
                   button_pen.setWidthF( PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
                 else
                   button_pen.setWidthF( 9./7.*PenWidth::Symbol*qMax((qreal)1.0, 20/width ) );
 
-                if ( ( ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle ) && ( this->hovered() || isChecked() ) )
+                if ( ( ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle ) && ( m_context.hovered || isChecked() ) )
                 {
                   // ring
                   painter->setBrush( Qt::NoBrush );
@@ -2460,7 +2635,7 @@ namespace Breeze
                 painter->drawEllipse( c, r, r );
                 painter->setBrush( Qt::NoBrush );
 
-                if ( this->hovered() || isChecked() || ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle )
+                if ( m_context.hovered || isChecked() || ( inactiveWindow && !useActiveButtonStyle ) || useInactiveButtonStyle )
                 {
                   painter->setPen( symbol_pen );
                   int startAngle = 260 * 16;
@@ -2495,20 +2670,20 @@ namespace Breeze
         painter->scale( width/20, width/20 );
         painter->translate( 1, 1 );
 
-        auto d = qobject_cast<Decoration*>( decoration() );
+        auto d = m_decoration.data();
 
-        bool inactiveWindow( d && !d->window()->isActive() );
-        bool isMatchTitleBarColor( d && d->internalSettings()->matchColorForTitleBar() );
+        bool inactiveWindow( d && !m_context.active );
+        bool isMatchTitleBarColor( d && m_context.matchColorForTitleBar );
 
         QColor darkSymbolColor( ( inactiveWindow && isMatchTitleBarColor ) ? QColor(81, 102, 107) : QColor(34, 45, 50) );
         QColor lightSymbolColor( ( inactiveWindow && isMatchTitleBarColor ) ? QColor(192, 193, 194) : QColor(250, 251, 252) );
 
-        QColor titleBarColor (d->titleBarColor());
+        QColor titleBarColor (m_context.titleBarColor);
 
         // symbols color
 
         QColor symbolColor;
-        bool isSystemForegroundColor( d && d->internalSettings()->systemForegroundColor() );
+        bool isSystemForegroundColor( d && m_context.systemForegroundColor );
         if (isSystemForegroundColor)
           symbolColor = this->fontColor();
         else {
@@ -2753,7 +2928,7 @@ namespace Breeze
             case DecorationButtonType::ApplicationMenu:
             {
                 QColor menuSymbolColor;
-                bool isSystemForegroundColor( d && d->internalSettings()->systemForegroundColor() );
+                bool isSystemForegroundColor( d && m_context.systemForegroundColor );
                 if (isSystemForegroundColor)
                   menuSymbolColor = this->fontColor();
                 else {
@@ -2830,20 +3005,20 @@ namespace Breeze
         painter->scale( width/20, width/20 );
         painter->translate( 1, 1 );
 
-        auto d = qobject_cast<Decoration*>( decoration() );
+        auto d = m_decoration.data();
 
-        bool inactiveWindow( d && !d->window()->isActive() );
-        bool isMatchTitleBarColor( d && d->internalSettings()->matchColorForTitleBar() );
+        bool inactiveWindow( d && !m_context.active );
+        bool isMatchTitleBarColor( d && m_context.matchColorForTitleBar );
 
         QColor darkSymbolColor( ( inactiveWindow && isMatchTitleBarColor ) ? QColor(81, 102, 107) : QColor(34, 45, 50) );
         QColor lightSymbolColor( ( inactiveWindow && isMatchTitleBarColor ) ? QColor(192, 193, 194) : QColor(250, 251, 252) );
 
-        QColor titleBarColor (d->titleBarColor());
+        QColor titleBarColor (m_context.titleBarColor);
 
         // symbols color
 
         QColor symbolColor;
-        bool isSystemForegroundColor( d && d->internalSettings()->systemForegroundColor() );
+        bool isSystemForegroundColor( d && m_context.systemForegroundColor );
         if (isSystemForegroundColor)
           symbolColor = this->fontColor();
         else {
@@ -3084,7 +3259,7 @@ namespace Breeze
             case DecorationButtonType::ApplicationMenu:
             {
                 QColor menuSymbolColor;
-                bool isSystemForegroundColor( d && d->internalSettings()->systemForegroundColor() );
+                bool isSystemForegroundColor( d && m_context.systemForegroundColor );
                 if (isSystemForegroundColor)
                   menuSymbolColor = this->fontColor();
                 else {
@@ -3168,12 +3343,12 @@ namespace Breeze
         QColor darkSymbolColor = QColor(34, 45, 50);
         QColor lightSymbolColor = QColor(250, 251, 252);
 
-        auto d = qobject_cast<Decoration*>( decoration() );
-        QColor titleBarColor (d->titleBarColor());
+        auto d = m_decoration.data();
+        QColor titleBarColor (m_context.titleBarColor);
 
         QColor symbolColor;
         QColor symbolBgdColor;
-        bool isSystemForegroundColor( d && d->internalSettings()->systemForegroundColor() );
+        bool isSystemForegroundColor( d && m_context.systemForegroundColor );
         if (isSystemForegroundColor) {
           symbolColor = this->foregroundColor();
           symbolBgdColor = this->backgroundColor();
@@ -3213,7 +3388,7 @@ namespace Breeze
             painter->setBrush( button_color );
 
             qreal r = static_cast<qreal>(7)
-            + static_cast<qreal>(2) * m_animation->currentValue().toReal();
+            + static_cast<qreal>(2) * m_opacity;
             QPointF c(static_cast<qreal>(9), static_cast<qreal>(9));
             painter->drawEllipse( c, r, r );
             painter->setBrush( Qt::NoBrush );
@@ -3238,7 +3413,7 @@ namespace Breeze
             painter->setBrush( button_color );
 
             qreal r = static_cast<qreal>(7)
-            + static_cast<qreal>(2) * m_animation->currentValue().toReal();
+            + static_cast<qreal>(2) * m_opacity;
             QPointF c(static_cast<qreal>(9), static_cast<qreal>(9));
             painter->drawEllipse( c, r, r );
             painter->setBrush( Qt::NoBrush );
@@ -3285,7 +3460,7 @@ namespace Breeze
           painter->setBrush( button_color );
 
           qreal r = static_cast<qreal>(7)
-          + static_cast<qreal>(2) * m_animation->currentValue().toReal();
+          + static_cast<qreal>(2) * m_opacity;
           QPointF c(static_cast<qreal>(9), static_cast<qreal>(9));
           painter->drawEllipse( c, r, r );
           painter->setBrush( Qt::NoBrush );
@@ -3311,7 +3486,7 @@ namespace Breeze
 
           if ( !isChecked() ) {
             qreal r = static_cast<qreal>(7)
-                      + static_cast<qreal>(2) * m_animation->currentValue().toReal();
+                      + static_cast<qreal>(2) * m_opacity;
             QPointF c(static_cast<qreal>(9), static_cast<qreal>(9));
             painter->drawEllipse( c, r, r );
           }
@@ -3324,7 +3499,7 @@ namespace Breeze
           button_color.setAlpha( 255 );
           symbolBgdColor.setAlpha( 255 );
           QColor mycolor = symbolColor;
-          if ( isChecked() && !this->hovered() )
+          if ( isChecked() && !m_context.hovered )
             mycolor = this->mixColors(symbolBgdColor, button_color, m_opacity);
           else
             mycolor = this->mixColors(button_color, symbolBgdColor, m_opacity);
@@ -3346,7 +3521,7 @@ namespace Breeze
 
           if ( !isChecked() ) {
             qreal r = static_cast<qreal>(7)
-                      + static_cast<qreal>(2) * m_animation->currentValue().toReal();
+                      + static_cast<qreal>(2) * m_opacity;
             QPointF c(static_cast<qreal>(9), static_cast<qreal>(9));
             painter->drawEllipse( c, r, r );
           }
@@ -3359,7 +3534,7 @@ namespace Breeze
           button_color.setAlpha( 255 );
           symbolBgdColor.setAlpha( 255 );
           QColor mycolor = symbolColor;
-          if ( isChecked() && !this->hovered() )
+          if ( isChecked() && !m_context.hovered )
             mycolor = this->mixColors(symbolBgdColor, button_color, m_opacity);
           else
             mycolor = this->mixColors(button_color, symbolBgdColor, m_opacity);
@@ -3402,7 +3577,7 @@ namespace Breeze
 
           if ( !isChecked() ) {
             qreal r = static_cast<qreal>(7)
-                      + static_cast<qreal>(2) * m_animation->currentValue().toReal();
+                      + static_cast<qreal>(2) * m_opacity;
             QPointF c(static_cast<qreal>(9), static_cast<qreal>(9));
             painter->drawEllipse( c, r, r );
           }
@@ -3415,7 +3590,7 @@ namespace Breeze
           button_color.setAlpha( 255 );
           symbolBgdColor.setAlpha( 255 );
           QColor mycolor = symbolColor;
-          if ( isChecked() && !this->hovered() )
+          if ( isChecked() && !m_context.hovered )
             mycolor = this->mixColors(symbolBgdColor, button_color, m_opacity);
           else
             mycolor = this->mixColors(button_color, symbolBgdColor, m_opacity);
@@ -3442,7 +3617,7 @@ namespace Breeze
 
           if ( !isChecked() ) {
             qreal r = static_cast<qreal>(7)
-                      + static_cast<qreal>(2) * m_animation->currentValue().toReal();
+                      + static_cast<qreal>(2) * m_opacity;
             QPointF c(static_cast<qreal>(9), static_cast<qreal>(9));
             painter->drawEllipse( c, r, r );
           }
@@ -3455,7 +3630,7 @@ namespace Breeze
           button_color.setAlpha( 255 );
           symbolBgdColor.setAlpha( 255 );
           QColor mycolor = symbolColor;
-          if ( isChecked() && !this->hovered() )
+          if ( isChecked() && !m_context.hovered )
             mycolor = this->mixColors(symbolBgdColor, button_color, m_opacity);
           else
             mycolor = this->mixColors(button_color, symbolBgdColor, m_opacity);
@@ -3491,7 +3666,7 @@ namespace Breeze
 
           if ( !isChecked() ) {
             qreal r = static_cast<qreal>(7)
-                      + static_cast<qreal>(2) * m_animation->currentValue().toReal();
+                      + static_cast<qreal>(2) * m_opacity;
             QPointF c(static_cast<qreal>(9), static_cast<qreal>(9));
             painter->drawEllipse( c, r, r );
           }
@@ -3542,13 +3717,13 @@ namespace Breeze
         QColor darkSymbolColor = QColor(34, 45, 50);
         QColor lightSymbolColor = QColor(250, 251, 252);
 
-        auto d = qobject_cast<Decoration*>( decoration() );
-        QColor titleBarColor (d->titleBarColor());
+        auto d = m_decoration.data();
+        QColor titleBarColor (m_context.titleBarColor);
 
         QColor symbolColor;
         QColor symbolBgdColor;
 
-        bool isSystemForegroundColor( d && d->internalSettings()->systemForegroundColor() );
+        bool isSystemForegroundColor( d && m_context.systemForegroundColor );
         if (isSystemForegroundColor) {
           symbolColor = this->foregroundColor();
           symbolBgdColor = this->backgroundColor();
@@ -3680,7 +3855,7 @@ namespace Breeze
                 button_color.setAlpha( 255 );
                 symbolBgdColor.setAlpha( 255 );
                 QColor mycolor = symbolColor;
-                if ( isChecked() && !this->hovered() )
+                if ( isChecked() && !m_context.hovered )
                   mycolor = this->mixColors(symbolBgdColor, button_color, m_opacity);
                 else
                   mycolor = this->mixColors(button_color, symbolBgdColor, m_opacity);
@@ -3728,7 +3903,7 @@ namespace Breeze
                 button_color.setAlpha( 255 );
                 symbolBgdColor.setAlpha( 255 );
                 QColor mycolor = symbolColor;
-                if ( isChecked() && !this->hovered() )
+                if ( isChecked() && !m_context.hovered )
                   mycolor = this->mixColors(symbolBgdColor, button_color, m_opacity);
                 else
                   mycolor = this->mixColors(button_color, symbolBgdColor, m_opacity);
@@ -3766,7 +3941,7 @@ namespace Breeze
                 button_color.setAlpha( 255 );
                 symbolBgdColor.setAlpha( 255 );
                 QColor mycolor = symbolColor;
-                if ( isChecked() && !this->hovered() )
+                if ( isChecked() && !m_context.hovered )
                   mycolor = this->mixColors(symbolBgdColor, button_color, m_opacity);
                 else
                   mycolor = this->mixColors(button_color, symbolBgdColor, m_opacity);
@@ -3797,7 +3972,7 @@ namespace Breeze
                 button_color.setAlpha( 255 );
                 symbolBgdColor.setAlpha( 255 );
                 QColor mycolor = symbolColor;
-                if ( isChecked() && !this->hovered() )
+                if ( isChecked() && !m_context.hovered )
                   mycolor = this->mixColors(symbolBgdColor, button_color, m_opacity);
                 else
                   mycolor = this->mixColors(button_color, symbolBgdColor, m_opacity);
@@ -3884,9 +4059,7 @@ namespace Breeze
     //__________________________________________________________________
     QColor Button::fontColor() const
     {
-        auto d = qobject_cast<Decoration*>( decoration() );
-        QColor titleBarColor ( d->titleBarColor() );
-
+        auto d = m_decoration.data();
         if( !d ) {
 
             return QColor();
@@ -3902,14 +4075,15 @@ namespace Breeze
     //__________________________________________________________________
     QColor Button::foregroundColor() const
     {
-        auto d = qobject_cast<Decoration*>( decoration() );
-        QColor titleBarColor ( d->titleBarColor() );
-
+        auto d = m_decoration.data();
         if( !d ) {
 
             return QColor();
 
-        } else if( isPressed() ) {
+        }
+
+        const QColor titleBarColor( d->titleBarColor() );
+        if( isPressed() ) {
 
             return titleBarColor;
 
@@ -3936,7 +4110,7 @@ namespace Breeze
         //__________________________________________________________________
     QColor Button::backgroundColor() const
     {
-        auto d = qobject_cast<Decoration*>( decoration() );
+        auto d = m_decoration.data();
         if( !d ) {
 
             return QColor();
@@ -3985,10 +4159,9 @@ namespace Breeze
     //__________________________________________________________________
     qreal Button::buttonRadius() const
     {
-        auto d = qobject_cast<Decoration*>( decoration() );
 
-        if ( d->internalSettings()->animationsEnabled() && ( !isChecked() || ( isChecked() && type() == DecorationButtonType::Maximize ) ) ) {
-          return static_cast<qreal>(7) + static_cast<qreal>(2) * m_animation->currentValue().toReal();
+        if ( m_context.animationsEnabled && ( !isChecked() || ( isChecked() && type() == DecorationButtonType::Maximize ) ) ) {
+          return static_cast<qreal>(7) + static_cast<qreal>(2) * m_opacity;
         }
         else
           return static_cast<qreal>(9);
@@ -4004,18 +4177,7 @@ namespace Breeze
             col = darkSymbolColor;
         else
         {
-            auto d = qobject_cast<Decoration*>( decoration() );
-            QColor titleBarColor ( d->titleBarColor() );
-
-            uint r = qRed(titleBarColor.rgb());
-            uint g = qGreen(titleBarColor.rgb());
-            uint b = qBlue(titleBarColor.rgb());
-
-            // modified from https://stackoverflow.com/questions/3942878/how-to-decide-font-color-in-white-or-black-depending-on-background-color
-            // qreal titleBarLuminance = (0.2126 * static_cast<qreal>(r) + 0.7152 * static_cast<qreal>(g) + 0.0722 * static_cast<qreal>(b)) / 255.;
-            // if ( titleBarLuminance >  sqrt(1.05 * 0.05) - 0.05 )
-            qreal colorConditional = 0.299 * static_cast<qreal>(r) + 0.587 * static_cast<qreal>(g) + 0.114 * static_cast<qreal>(b);
-            if ( colorConditional > 186 || g > 186 )
+            if ( m_context.lightTitleBar )
                 col = darkSymbolColor;
             else
                 col = lightSymbolColor;
@@ -4026,7 +4188,7 @@ namespace Breeze
     //__________________________________________________________________
     bool Button::hovered() const
     {
-      auto d = qobject_cast<Decoration*>( decoration() );
+      auto d = m_decoration.data();
       return isHovered() || ( d->buttonHovered() && d->internalSettings()->unisonHovering() );
     }
 
@@ -4035,8 +4197,36 @@ namespace Breeze
     {
 
         // animation
-        auto d = qobject_cast<Decoration*>(decoration());
-        if( d )  m_animation->setDuration( d->internalSettings()->animationsDuration() );
+        auto d = m_decoration.data();
+        if( d )
+        {
+            m_animation->setDuration( d->internalSettings()->animationsDuration() );
+            m_animationFrames = d->internalSettings()->animationFrames();
+        }
+
+        // icon renderer, picked once here rather than on every paint
+        // the active and inactive variants of the SBE styles share their renderer
+        static const DrawIconFunction renderers[] = {
+            &Button::drawIconPlasma,
+            &Button::drawIconGnome,
+            &Button::drawIconMacSierra,
+            &Button::drawIconMacDarkAurorae,
+            &Button::drawIconSBEsierra,
+            &Button::drawIconSBEsierra,
+            &Button::drawIconSBEsierra,
+            &Button::drawIconSBEdarkAurorae,
+            &Button::drawIconSBEdarkAurorae,
+            &Button::drawIconSBEdarkAurorae,
+            &Button::drawIconSierraColorSymbols,
+            &Button::drawIconDarkAuroraeColorSymbols,
+            &Button::drawIconSierraMonochromeSymbols,
+            &Button::drawIconDarkAuroraeMonochromeSymbols
+        };
+
+        static_assert( std::size( renderers ) == PaintProfiler::ButtonStyleCount );
+
+        m_buttonStyle = d ? qBound( 0, d->internalSettings()->buttonStyle(), int( std::size( renderers ) ) - 1 ) : 0;
+        m_drawIcon = renderers[m_buttonStyle];
 
     }
 
@@ -4044,8 +4234,8 @@ namespace Breeze
     void Button::updateAnimationState( bool hovered )
     {
 
-        auto d = qobject_cast<Decoration*>(decoration());
-        if( !d || !d->internalSettings()->animationsEnabled() || (d->internalSettings()->buttonStyle() == 1) ) return;
+        auto d = m_decoration.data();
+        if( !d || !d->internalSettings()->animationsEnabled() || m_buttonStyle == 1 ) return;
 
         QAbstractAnimation::Direction dir = hovered ? QAbstractAnimation::Forward : QAbstractAnimation::Backward;
         if( m_animation->state() == QAbstractAnimation::Running && m_animation->direction() != dir )
@@ -26,6 +26,7 @@
 
 #include <QHash>
 #include <QImage>
+#include <QPointer>
 
 #include <QVariantAnimation>
 
@@ -52,6 +53,17 @@ namespace Breeze
         //* render
         virtual void paint(QPainter *painter, const QRectF &repaintRegion) override;
 
+        //* icon sprite, positioned in untransformed logical coordinates
+        struct Blit
+        {
+            QPointF position;
+            QImage image;
+        };
+
+        //* render as part of the title bar, leaving painter state to the caller
+        //* icons served from the sprites are appended to blits, for the decoration to draw them all at once
+        void paintBatched(QPainter *painter, const QRectF &repaintRegion, QList<Blit> &blits);
+
         //* flag
         enum Flag
         {
@@ -111,6 +123,31 @@ namespace Breeze
         //* private constructor
         explicit Button(KDecoration3::DecorationButtonType type, Decoration *decoration, QObject *parent = nullptr);
 
+        //* everything the icon renderers read from the decoration, gathered once per paint.
+        //* Only valid inside paint(), the color getters read the decoration directly
+        struct PaintContext
+        {
+            bool active = false;
+            bool hovered = false;
+            bool animationsEnabled = false;
+            bool matchColorForTitleBar = false;
+            bool systemForegroundColor = false;
+            bool lightTitleBar = false;
+            QColor titleBarColor;
+            QColor fontColor;
+        };
+
+        //* refresh paint context from the decoration
+        void updatePaintContext();
+
+        //* offset applied to the button geometry when rendering
+        QPointF renderOffset() const
+        { return m_flag == FlagFirstInList ? m_offset : QPointF( 0, m_offset.y() ); }
+
+        //* button icon from the shared sprites, rasterizing it first if needed
+        //* false if the transform does not allow blitting, in which case the icon is to be drawn directly
+        bool iconSprite( const QTransform &, qreal devicePixelRatio, Blit & ) const;
+
         //* draw button icon
         void drawIconPlasma( QPainter *) const;
         void drawIconGnome( QPainter *) const;
@@ -144,6 +181,12 @@ namespace Breeze
 
         Flag m_flag = FlagNone;
 
+        //* owning decoration, resolved once at construction
+        QPointer<Decoration> m_decoration;
+
+        //* decoration state for the paint in progress
+        PaintContext m_context;
+
         //* active state change animation
         QVariantAnimation *m_animation;
 
@@ -155,6 +198,14 @@ namespace Breeze
 
         //* active state change opacity
         qreal m_opacity = 0;
+
+        //* distinct opacities the animation goes through
+        int m_animationFrames = 16;
+
+        //* configured button style, and the matching icon renderer
+        using DrawIconFunction = void (Button::*)( QPainter *) const;
+        int m_buttonStyle = 0;
+        DrawIconFunction m_drawIcon = &Button::drawIconPlasma;
     };
 
 } // namespace
@@ -28,6 +28,8 @@
 #include "config/breezeconfigwidget.h"
 
 #include "breezebutton.h"
+#include "breezepaintprofiler.h"
+#include "breezeshadowatlas.h"
 #include "breezesizegrip.h"
 
 #include "breezeboxshadowrenderer.h"
@@ -42,9 +44,15 @@
 #include <KSharedConfig>
 #include <KPluginFactory>
 
+#include <QFutureWatcher>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QLoggingCategory>
 #include <QPainter>
 #include <QTextStream>
 #include <QTimer>
+#include <QtMath>
+#include <QtConcurrent>
 
 #if BREEZE_HAVE_X11
 #include <QtGui/private/qtx11extras_p.h>
@@ -139,27 +147,21 @@ namespace
         }
     }
 
-    inline CompositeShadowParams lookupShadowParamsInactiveWindows(int size)
-    {
-        switch (size)
-        {
-        case Breeze::InternalSettings::ShadowNoneInactiveWindows:
-            return s_shadowParams[0];
-        case Breeze::InternalSettings::ShadowSmallInactiveWindows:
-            return s_shadowParams[1];
-        case Breeze::InternalSettings::ShadowMediumInactiveWindows:
-            return s_shadowParams[2];
-        case Breeze::InternalSettings::ShadowLargeInactiveWindows:
-            return s_shadowParams[3];
-        case Breeze::InternalSettings::ShadowVeryLargeInactiveWindows:
-            return s_shadowParams[4];
-        default:
-            // Fallback to the Large size.
-            return s_shadowParams[3];
-        }
-    }
+    // inactive windows pick their size from the same table, so a shadow key
+    // does not need to know which of the two settings it was built from
+    static_assert(int(Breeze::InternalSettings::ShadowNoneInactiveWindows) == int(Breeze::InternalSettings::ShadowNone));
+    static_assert(int(Breeze::InternalSettings::ShadowSmallInactiveWindows) == int(Breeze::InternalSettings::ShadowSmall));
+    static_assert(int(Breeze::InternalSettings::ShadowMediumInactiveWindows) == int(Breeze::InternalSettings::ShadowMedium));
+    static_assert(int(Breeze::InternalSettings::ShadowLargeInactiveWindows) == int(Breeze::InternalSettings::ShadowLarge));
+    static_assert(int(Breeze::InternalSettings::ShadowVeryLargeInactiveWindows) == int(Breeze::InternalSettings::ShadowVeryLarge));
+
+    //* number of cached shadows above which unused ones are dropped
+    const int s_shadowCacheSize = 8;
 }
 
+// shadow rendering cost, enable with QT_LOGGING_RULES="sierrabreezeenhanced.shadow.debug=true"
+Q_LOGGING_CATEGORY(SIERRABREEZEENHANCED_SHADOW, "sierrabreezeenhanced.shadow", QtWarningMsg)
+
 namespace Breeze
 {
 
@@ -168,20 +170,160 @@ namespace Breeze
 
     //________________________________________________________________
     static int g_sDecoCount = 0;
-    static int g_shadowSizeEnum = InternalSettings::ShadowLarge;
-    static int g_shadowStrength = 255;
-    static QColor g_shadowColor = Qt::black;
-    static std::shared_ptr<KDecoration3::DecorationShadow> g_sShadow;
-    static bool g_specificShadowsInactiveWindows = false;
-    static int g_shadowSizeEnumInactiveWindows = InternalSettings::ShadowLarge;
-    static int g_shadowStrengthInactiveWindows = 255;
-    static QColor g_shadowColorInactiveWindows = Qt::black;
+
+    //* shadows shared by all decorations, active and inactive alike
+    static QHash<ShadowKey, std::shared_ptr<KDecoration3::DecorationShadow>> g_shadowCache;
+
+    //________________________________________________________________
+    static void insertShadow(const ShadowKey &key, const std::shared_ptr<KDecoration3::DecorationShadow> &shadow)
+    {
+        if (g_shadowCache.size() >= s_shadowCacheSize)
+        {
+            // drop the shadows no decoration is holding anymore
+            for (auto it = g_shadowCache.begin(); it != g_shadowCache.end();)
+            {
+                if (it.value().use_count() <= 1)
+                    it = g_shadowCache.erase(it);
+                else
+                    ++it;
+            }
+        }
+
+        g_shadowCache.insert(key, shadow);
+    }
+
+    //________________________________________________________________
+    static std::shared_ptr<KDecoration3::DecorationShadow> createShadowObject(const ShadowTexture &texture)
+    {
+        auto shadow = std::make_shared<KDecoration3::DecorationShadow>();
+        shadow->setPadding(texture.padding);
+        shadow->setInnerShadowRect(texture.innerShadowRect);
+        shadow->setShadow(texture.image);
+        return shadow;
+    }
+
+    //________________________________________________________________
+    static ShadowTexture renderShadowTexture(const ShadowKey &key, const CompositeShadowParams &params)
+    {
+        // this runs in a worker thread as well, so it must depend on nothing but its arguments
+        PaintProfiler::Scope profile(PaintProfiler::ShadowRender);
+        QElapsedTimer timer;
+        const bool timed = SIERRABREEZEENHANCED_SHADOW().isDebugEnabled();
+        if (timed)
+            timer.start();
+
+        auto withOpacity = [](const QColor &color, qreal opacity) -> QColor
+        {
+            QColor c(color);
+            c.setAlphaF(opacity);
+            return c;
+        };
+
+        const qreal cornerRadius = 0.5 * key.smallSpacing * (key.cornerRadius + 0.5);
+
+        // the box only needs to let the shadows reach their full strength past its rounded corners,
+        // anything larger is rendered only to be masked out again below
+        const QSize boxSize = BoxShadowRenderer::calculateMinimumBoxSize(params.shadow1.radius, cornerRadius)
+                                  .expandedTo(BoxShadowRenderer::calculateMinimumBoxSize(params.shadow2.radius, cornerRadius));
+
+        BoxShadowRenderer shadowRenderer;
+        shadowRenderer.setBorderRadius(cornerRadius);
+        shadowRenderer.setBoxSize(boxSize);
+        shadowRenderer.setDevicePixelRatio(key.devicePixelRatio);
+
+        const QColor color = QColor::fromRgba(key.color);
+        const qreal strength = static_cast<qreal>(key.strength) / 255.0;
+        shadowRenderer.addShadow(params.shadow1.offset, params.shadow1.radius,
+                                 withOpacity(color, params.shadow1.opacity * strength));
+        shadowRenderer.addShadow(params.shadow2.offset, params.shadow2.radius,
+                                 withOpacity(color, params.shadow2.opacity * strength));
+
+        QImage shadowTexture = shadowRenderer.render();
+        const qint64 renderTime = timed ? timer.nsecsElapsed() : 0;
+
+        QPainter painter(&shadowTexture);
+        painter.setRenderHint(QPainter::Antialiasing);
+
+        // padding and inner rect are in logical coordinates, like the painter
+        const QRect outerRect(QPoint(0, 0), shadowTexture.deviceIndependentSize().toSize());
+
+        QRect boxRect(QPoint(0, 0), boxSize);
+        boxRect.moveCenter(outerRect.center());
+
+        // Mask out inner rect.
+        const QMargins padding = QMargins(
+            boxRect.left() - outerRect.left() - Metrics::Shadow_Overlap - params.offset.x(),
+            boxRect.top() - outerRect.top() - Metrics::Shadow_Overlap - params.offset.y(),
+            outerRect.right() - boxRect.right() - Metrics::Shadow_Overlap + params.offset.x(),
+            outerRect.bottom() - boxRect.bottom() - Metrics::Shadow_Overlap + params.offset.y());
+        const QRect innerRect = outerRect - padding;
+
+        painter.setPen(Qt::NoPen);
+        painter.setBrush(Qt::black);
+        painter.setCompositionMode(QPainter::CompositionMode_DestinationOut);
+        painter.drawRoundedRect(innerRect, cornerRadius, cornerRadius);
+
+        // Draw outline.
+        // painter.setPen(withOpacity(color, 0.2 * strength));
+        // painter.setBrush(Qt::NoBrush);
+        // painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+        // painter.drawRoundedRect(
+        //     innerRect,
+        //     0.5*key.smallSpacing*(key.cornerRadius - 0.5),
+        //     0.5*key.smallSpacing*(key.cornerRadius - 0.5));
+
+        painter.end();
+
+        ShadowTexture texture;
+        texture.image = shadowTexture;
+        texture.padding = padding;
+        texture.innerShadowRect = QRect(outerRect.center(), QSize(1, 1));
+
+        if (timed)
+        {
+            qCDebug(SIERRABREEZEENHANCED_SHADOW) << "size" << key.size << "spacing" << key.smallSpacing << "dpr" << key.devicePixelRatio
+                                                 << "render" << renderTime << "ns total" << timer.nsecsElapsed() << "ns"
+                                                 << shadowTexture.size() << shadowTexture.sizeInBytes() << "bytes";
+        }
+
+        return texture;
+    }
+
+    //* shadow textures being rendered in the background
+    static QHash<ShadowKey, QFuture<ShadowTexture>> g_pendingShadows;
+
+    //________________________________________________________________
+    static QFuture<ShadowTexture> renderShadowTextureAsync(const ShadowKey &key, const CompositeShadowParams &params)
+    {
+        // decorations asking for the same shadow share one job
+        const auto pending = g_pendingShadows.constFind(key);
+        if (pending != g_pendingShadows.constEnd())
+            return pending.value();
+
+        const QFuture<ShadowTexture> future = QtConcurrent::run(renderShadowTexture, key, params);
+        g_pendingShadows.insert(key, future);
+        return future;
+    }
+
+    //________________________________________________________________
+    static std::shared_ptr<KDecoration3::DecorationShadow> storeShadow(const ShadowKey &key, const ShadowTexture &texture)
+    {
+        ShadowAtlas::self()->insert(key, texture);
+
+        auto shadow = createShadowObject(texture);
+        insertShadow(key, shadow);
+        return shadow;
+    }
 
     //________________________________________________________________
     Decoration::Decoration(QObject *parent, const QVariantList &args)
         : KDecoration3::Decoration(parent, args), m_animation(new QVariantAnimation(this))
     {
         g_sDecoCount++;
+
+        // the profiler must live in the main thread, shadows record into it from workers
+        if (PaintProfiler::enabled())
+            PaintProfiler::self();
     }
 
     //________________________________________________________________
@@ -190,8 +332,11 @@ namespace Breeze
         g_sDecoCount--;
         if (g_sDecoCount == 0)
         {
-            // last deco destroyed, clean up shadow
-            g_sShadow.reset();
+            // last deco destroyed, clean up shadows
+            for (QFuture<ShadowTexture> &future : g_pendingShadows)
+                future.waitForFinished();
+            g_pendingShadows.clear();
+            g_shadowCache.clear();
         }
 
         deleteSizeGrip();
@@ -203,6 +348,7 @@ namespace Breeze
         if (m_opacity == value)
             return;
         m_opacity = value;
+        invalidateColors();
         update();
 
         if (m_sizeGrip)
@@ -210,124 +356,105 @@ namespace Breeze
     }
 
     //________________________________________________________________
-    QColor Decoration::titleBarColor() const
+    const Decoration::Colors &Decoration::colors() const
     {
-        QColor titleBarColor(this->rawTitleBarColor());
-        QColor outlineColor(this->outlineColor());
-
-        auto c(window());
-        if (drawBackgroundGradient()) // && c->isActive() )
-        {
-            if (c->isActive())
-            {
-                if (qGray(titleBarColor.rgb()) > 69)
-                {
-                    if (outlineColor.isValid())
-                        titleBarColor = titleBarColor.darker(115);
-                }
-                else
-                {
-                    if (outlineColor.isValid())
-                        titleBarColor = titleBarColor.lighter(115);
-                }
-            }
-            else
-            {
-                if (qGray(titleBarColor.rgb()) > 69)
-                {
-                    if (outlineColor.isValid())
-                        titleBarColor = titleBarColor.darker(110);
-                }
-                else
-                {
-                    if (outlineColor.isValid())
-                        titleBarColor = titleBarColor.lighter(110);
-                }
-            }
-        }
-        else if (outlineColor.isValid() && c->isActive())
+        if (!m_colorsValid)
         {
-            if (qGray(titleBarColor.rgb()) > 69)
-                titleBarColor = titleBarColor.darker(115);
-            else
-                titleBarColor = titleBarColor.lighter(115);
-        }
-        else if (outlineColor.isValid())
-        {
-            if (qGray(titleBarColor.rgb()) > 69)
-                titleBarColor = titleBarColor.darker(110);
-            else
-                titleBarColor = titleBarColor.lighter(110);
+            m_colors = computeColors();
+            m_colorsValid = true;
         }
-        return titleBarColor;
+
+        return m_colors;
     }
 
     //________________________________________________________________
-    QColor Decoration::outlineColor() const
+    void Decoration::invalidateColors()
     {
-        if (!m_internalSettings->drawTitleBarSeparator())
-            return QColor();
-
-        QColor titleBarColor(rawTitleBarColor());
-
-        uint r = qRed(titleBarColor.rgb());
-        uint g = qGreen(titleBarColor.rgb());
-        uint b = qBlue(titleBarColor.rgb());
-
-        qreal colorConditional = 0.299 * static_cast<qreal>(r) + 0.587 * static_cast<qreal>(g) + 0.114 * static_cast<qreal>(b);
-
-        QColor outlineColor;
-        if (colorConditional > 69) // 255 -186
-            outlineColor = titleBarColor.darker(140);
-        else
-            outlineColor = titleBarColor.lighter(140);
+        m_colorsValid = false;
 
-        return outlineColor;
+        // whether the title bar lets anything through depends on the colors as well
+        scheduleUpdate(BlurUpdate);
     }
 
     //________________________________________________________________
-    QColor Decoration::rawTitleBarColor() const
+    Decoration::Colors Decoration::computeColors() const
     {
         auto c = window();
-        QColor titleBarColor;
+        Colors colors;
 
+        // raw title bar color
+        QColor rawTitleBarColor;
         if (!matchColorForTitleBar())
         {
             if (m_animation->state() == QAbstractAnimation::Running)
             {
-                titleBarColor = KColorUtils::mix(
+                rawTitleBarColor = KColorUtils::mix(
                     c->color(ColorGroup::Inactive, ColorRole::TitleBar),
                     c->color(ColorGroup::Active, ColorRole::TitleBar),
                     m_opacity);
             }
             else
-                titleBarColor = c->color(c->isActive() ? ColorGroup::Active : ColorGroup::Inactive, ColorRole::TitleBar);
+                rawTitleBarColor = c->color(c->isActive() ? ColorGroup::Active : ColorGroup::Inactive, ColorRole::TitleBar);
         }
         else
         {
-            titleBarColor = c->palette().color(QPalette::Window);
+            rawTitleBarColor = c->palette().color(QPalette::Window);
         }
-        titleBarColor.setAlpha(titleBarAlpha());
-        return titleBarColor;
-    }
+        rawTitleBarColor.setAlpha(titleBarAlpha());
+        colors.rawTitleBar = rawTitleBarColor;
 
-    //________________________________________________________________
-    QColor Decoration::fontColor() const
-    {
-        auto c = window();
+        // outline
+        if (m_internalSettings->drawTitleBarSeparator())
+        {
+            uint r = qRed(rawTitleBarColor.rgb());
+            uint g = qGreen(rawTitleBarColor.rgb());
+            uint b = qBlue(rawTitleBarColor.rgb());
+
+            qreal colorConditional = 0.299 * static_cast<qreal>(r) + 0.587 * static_cast<qreal>(g) + 0.114 * static_cast<qreal>(b);
 
+            if (colorConditional > 69) // 255 -186
+                colors.outline = rawTitleBarColor.darker(140);
+            else
+                colors.outline = rawTitleBarColor.lighter(140);
+        }
+
+        // title bar, set apart from the rest of the window when there is an outline
+        QColor titleBarColor(rawTitleBarColor);
+        if (colors.outline.isValid())
+        {
+            const int factor = c->isActive() ? 115 : 110;
+            if (qGray(titleBarColor.rgb()) > 69)
+                titleBarColor = titleBarColor.darker(factor);
+            else
+                titleBarColor = titleBarColor.lighter(factor);
+        }
+        colors.titleBar = titleBarColor;
+
+        // modified from https://stackoverflow.com/questions/3942878/how-to-decide-font-color-in-white-or-black-depending-on-background-color
+        // qreal titleBarLuminance = (0.2126 * static_cast<qreal>(r) + 0.7152 * static_cast<qreal>(g) + 0.0722 * static_cast<qreal>(b)) / 255.;
+        // if ( titleBarLuminance >  sqrt(1.05 * 0.05) - 0.05 )
+        {
+            uint r = qRed(titleBarColor.rgb());
+            uint g = qGreen(titleBarColor.rgb());
+            uint b = qBlue(titleBarColor.rgb());
+
+            qreal colorConditional = 0.299 * static_cast<qreal>(r) + 0.587 * static_cast<qreal>(g) + 0.114 * static_cast<qreal>(b);
+            colors.lightTitleBar = colorConditional > 186 || g > 186; // ( colorConditional > 186 ) // if ( colorConditional > 150 )
+        }
+
+        // font
         if (systemForegroundColor())
         {
             if (m_animation->state() == QAbstractAnimation::Running)
             {
-                return KColorUtils::mix(
+                colors.font = KColorUtils::mix(
                     c->color(ColorGroup::Inactive, ColorRole::Foreground),
                     c->color(ColorGroup::Active, ColorRole::Foreground),
                     m_opacity);
             }
             else
             {
-                return c->color(c->isActive() ? ColorGroup::Active : ColorGroup::Inactive, ColorRole::Foreground);
+                colors.font = c->color(c->isActive() ? ColorGroup::Active : ColorGroup::Inactive, ColorRole::Foreground);
             }
         }
         else
@@ -335,21 +462,10 @@ namespace Breeze
             QColor darkTextColor(!c->isActive() && matchColorForTitleBar() ? QColor(81, 102, 107) : QColor(34, 45, 50));
             QColor lightTextColor(!c->isActive() && matchColorForTitleBar() ? QColor(192, 193, 194) : QColor(250, 251, 252));
 
-            QColor titleBarColor = this->titleBarColor();
-
-            uint r = qRed(titleBarColor.rgb());
-            uint g = qGreen(titleBarColor.rgb());
-            uint b = qBlue(titleBarColor.rgb());
-
-            // modified from https://stackoverflow.com/questions/3942878/how-to-decide-font-color-in-white-or-black-depending-on-background-color
-            // qreal titleBarLuminance = (0.2126 * static_cast<qreal>(r) + 0.7152 * static_cast<qreal>(g) + 0.0722 * static_cast<qreal>(b)) / 255.;
-            // if ( titleBarLuminance >  sqrt(1.05 * 0.05) - 0.05 )
-            qreal colorConditional = 0.299 * static_cast<qreal>(r) + 0.587 * static_cast<qreal>(g) + 0.114 * static_cast<qreal>(b);
-            if (colorConditional > 186 || g > 186) // ( colorConditional > 186 ) // if ( colorConditional > 150 )
-                return darkTextColor;
-            else
-                return lightTextColor;
+            colors.font = colors.lightTitleBar ? darkTextColor : lightTextColor;
         }
+
+        return colors;
     }
 
     //________________________________________________________________
@@ -393,22 +509,24 @@ namespace Breeze
         updateTitleBar();
         auto s = settings();
         connect(s.get(), &KDecoration3::DecorationSettings::borderSizeChanged, this, &Decoration::recalculateBorders);
-        connect(s.get(), &KDecoration3::DecorationSettings::borderSizeChanged, this, &Decoration::updateBlur); // for the case when a border with transparency
+        connect(s.get(), &KDecoration3::DecorationSettings::borderSizeChanged, this, [this]() { scheduleUpdate(BlurUpdate); }); // for the case when a border with transparency
 
         // a change in font might cause the borders to change
         connect(s.get(), &KDecoration3::DecorationSettings::fontChanged, this, &Decoration::recalculateBorders); // recalculateBorders();
-        connect(s.get(), &KDecoration3::DecorationSettings::fontChanged, this, &Decoration::updateBlur);         // for the case when a border with transparency
+        connect(s.get(), &KDecoration3::DecorationSettings::fontChanged, this, [this]() { scheduleUpdate(BlurUpdate); }); // for the case when a border with transparency
+        connect(s.get(), &KDecoration3::DecorationSettings::fontChanged, this, &Decoration::invalidateCaption);
         connect(s.get(), &KDecoration3::DecorationSettings::spacingChanged, this, &Decoration::recalculateBorders);
-        connect(s.get(), &KDecoration3::DecorationSettings::spacingChanged, this, &Decoration::updateBlur); // for the case when a border with transparency
+        connect(s.get(), &KDecoration3::DecorationSettings::spacingChanged, this, [this]() { scheduleUpdate(BlurUpdate); }); // for the case when a border with transparency
 
         // buttons
         connect(s.get(), &KDecoration3::DecorationSettings::spacingChanged, this, &Decoration::updateButtonsGeometryDelayed);
         connect(s.get(), &KDecoration3::DecorationSettings::decorationButtonsLeftChanged, this, &Decoration::updateButtonsGeometryDelayed);
         connect(s.get(), &KDecoration3::DecorationSettings::decorationButtonsRightChanged, this, &Decoration::updateButtonsGeometryDelayed);
 
-        // full reconfiguration
-        connect(s.get(), &KDecoration3::DecorationSettings::reconfigured, this, &Decoration::reconfigure);
+        // full reconfiguration. The settings provider reloads the configuration first,
+        // it is connected by the first decoration, ahead of every decoration's own slots
         connect(s.get(), &KDecoration3::DecorationSettings::reconfigured, SettingsProvider::self(), &SettingsProvider::reconfigure, Qt::UniqueConnection);
+        connect(s.get(), &KDecoration3::DecorationSettings::reconfigured, this, &Decoration::reconfigure);
         connect(s.get(), &KDecoration3::DecorationSettings::reconfigured, this, &Decoration::updateButtonsGeometryDelayed);
 
         connect(c, &KDecoration3::DecoratedWindow::adjacentScreenEdgesChanged, this, &Decoration::recalculateBorders);
@@ -419,19 +537,28 @@ namespace Breeze
                 [this]()
                 {
                     // update the caption area
+                    invalidateCaption();
                     update(titleBar());
                 });
 
+        connect(c, &KDecoration3::DecoratedWindow::activeChanged, this, &Decoration::invalidateColors);
+        connect(c, &KDecoration3::DecoratedWindow::paletteChanged, this, &Decoration::invalidateColors);
+        connect(m_animation, &QAbstractAnimation::stateChanged, this, &Decoration::invalidateColors);
         connect(c, &KDecoration3::DecoratedWindow::activeChanged, this, &Decoration::updateAnimationState);
         connect(c, &KDecoration3::DecoratedWindow::activeChanged, this, &Decoration::createShadow);
-        connect(c, &KDecoration3::DecoratedWindow::activeChanged, this, &Decoration::updateBlur);
+        connect(c, &KDecoration3::DecoratedWindow::nextScaleChanged, this, &Decoration::createShadow);
+        // geometry follows the window right away, or KWin may paint a frame with buttons at the old size
         connect(c, &KDecoration3::DecoratedWindow::widthChanged, this, &Decoration::updateTitleBar);
+        connect(c, &KDecoration3::DecoratedWindow::widthChanged, this, &Decoration::updateButtonsGeometry);
+        connect(c, &KDecoration3::DecoratedWindow::widthChanged, this, &Decoration::invalidateTitleBarBackground);
+        connect(c, &KDecoration3::DecoratedWindow::widthChanged, this, &Decoration::invalidateCaption);
+        connect(c, &KDecoration3::DecoratedWindow::activeChanged, this, &Decoration::invalidateTitleBarBackground);
         connect(c, &KDecoration3::DecoratedWindow::maximizedChanged, this, &Decoration::updateTitleBar);
+        connect(c, &KDecoration3::DecoratedWindow::maximizedChanged, this, &Decoration::updateButtonsGeometry);
+        connect(c, &KDecoration3::DecoratedWindow::maximizedChanged, this, [this]() { scheduleUpdate(BlurUpdate); });
         // connect(c, &KDecoration3::DecoratedWindow::maximizedChanged, this, &Decoration::setOpaque);
-        connect(c, &KDecoration3::DecoratedWindow::sizeChanged, this, &Decoration::updateBlur);
+        connect(c, &KDecoration3::DecoratedWindow::sizeChanged, this, [this]() { scheduleUpdate(BlurUpdate); });
 
-        connect(c, &KDecoration3::DecoratedWindow::widthChanged, this, &Decoration::updateButtonsGeometry);
-        connect(c, &KDecoration3::DecoratedWindow::maximizedChanged, this, &Decoration::updateButtonsGeometry);
         connect(c, &KDecoration3::DecoratedWindow::adjacentScreenEdgesChanged, this, &Decoration::updateButtonsGeometry);
         connect(c, &KDecoration3::DecoratedWindow::shadedChanged, this, &Decoration::updateButtonsGeometry);
 
@@ -473,176 +600,81 @@ namespace Breeze
     }
 
     //________________________________________________________________
-    void Decoration::updateShadow()
+    ShadowKey Decoration::shadowKey() const
     {
-        auto c = window();
-
-        if (!g_specificShadowsInactiveWindows || c->isActive())
-            updateActiveShadow();
+        ShadowKey key;
+        if (!m_internalSettings->specificShadowsInactiveWindows() || window()->isActive())
+        {
+            key.size = m_internalSettings->shadowSize();
+            key.strength = m_internalSettings->shadowStrength();
+            key.color = m_internalSettings->shadowColor().rgba();
+        }
         else
-            updateInactiveShadow();
+        {
+            key.size = m_internalSettings->shadowSizeInactiveWindows();
+            key.strength = m_internalSettings->shadowStrengthInactiveWindows();
+            key.color = m_internalSettings->shadowColorInactiveWindows().rgba();
+        }
+
+        key.cornerRadius = m_internalSettings->cornerRadius();
+        key.smallSpacing = settings()->smallSpacing();
+        key.devicePixelRatio = window()->nextScale();
+        return key;
     }
 
     //________________________________________________________________
-    void Decoration::updateActiveShadow()
+    void Decoration::updateShadow()
     {
+        const ShadowKey key = shadowKey();
 
-        CompositeShadowParams params;
-        params = lookupShadowParams(g_shadowSizeEnum);
-
-        if (params.isNone())
+        // reuse the shadow already rendered for any decoration with the same parameters,
+        // which makes focus changes free once both the active and inactive shadow exist
+        const auto cached = g_shadowCache.constFind(key);
+        if (cached != g_shadowCache.constEnd())
         {
-            g_sShadow.reset();
-            setShadow(g_sShadow);
+            setShadow(cached.value());
             return;
         }
 
-        auto withOpacity = [](const QColor &color, qreal opacity) -> QColor
-        {
-            QColor c(color);
-            c.setAlphaF(opacity);
-            return c;
-        };
-
-        const auto s = settings();
-
-        const QSize boxSize = BoxShadowRenderer::calculateMinimumBoxSize(2 * s->smallSpacing() * params.shadow1.radius)
-                                  .expandedTo(BoxShadowRenderer::calculateMinimumBoxSize(2 * s->smallSpacing() * params.shadow2.radius));
-
-        BoxShadowRenderer shadowRenderer;
-        shadowRenderer.setBorderRadius(0.5 * s->smallSpacing() * (m_internalSettings->cornerRadius() + 0.5));
-        shadowRenderer.setBoxSize(boxSize);
-
-        const qreal strength = static_cast<qreal>(g_shadowStrength) / 255.0;
-        shadowRenderer.addShadow(params.shadow1.offset, params.shadow1.radius,
-                                 withOpacity(g_shadowColor, params.shadow1.opacity * strength));
-        shadowRenderer.addShadow(params.shadow2.offset, params.shadow2.radius,
-                                 withOpacity(g_shadowColor, params.shadow2.opacity * strength));
-
-        QImage shadowTexture = shadowRenderer.render();
-
-        QPainter painter(&shadowTexture);
-        painter.setRenderHint(QPainter::Antialiasing);
-
-        const QRect outerRect = shadowTexture.rect();
-
-        QRect boxRect(QPoint(0, 0), boxSize);
-        boxRect.moveCenter(outerRect.center());
-
-        // Mask out inner rect.
-        const QMargins padding = QMargins(
-            boxRect.left() - outerRect.left() - Metrics::Shadow_Overlap - params.offset.x(),
-            boxRect.top() - outerRect.top() - Metrics::Shadow_Overlap - params.offset.y(),
-            outerRect.right() - boxRect.right() - Metrics::Shadow_Overlap + params.offset.x(),
-            outerRect.bottom() - boxRect.bottom() - Metrics::Shadow_Overlap + params.offset.y());
-        const QRect innerRect = outerRect - padding;
-
-        painter.setPen(Qt::NoPen);
-        painter.setBrush(Qt::black);
-        painter.setCompositionMode(QPainter::CompositionMode_DestinationOut);
-        painter.drawRoundedRect(
-            innerRect,
-            0.5 * s->smallSpacing() * (m_internalSettings->cornerRadius() + 0.5),
-            0.5 * s->smallSpacing() * (m_internalSettings->cornerRadius() + 0.5));
-
-        // Draw outline.
-        // painter.setPen(withOpacity(g_shadowColor, 0.2 * strength));
-        // painter.setBrush(Qt::NoBrush);
-        // painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
-        // painter.drawRoundedRect(
-        //     innerRect,
-        //     0.5*s->smallSpacing()*(m_internalSettings->cornerRadius() - 0.5),
-        //     0.5*s->smallSpacing()*(m_internalSettings->cornerRadius() - 0.5));
-
-        painter.end();
-
-        g_sShadow = std::make_shared<KDecoration3::DecorationShadow>();
-        g_sShadow->setPadding(padding);
-        g_sShadow->setInnerShadowRect(QRect(outerRect.center(), QSize(1, 1)));
-        g_sShadow->setShadow(shadowTexture);
-
-        setShadow(g_sShadow);
-    }
-
-    //________________________________________________________________
-    void Decoration::updateInactiveShadow()
-    {
-
-        CompositeShadowParams params;
-        params = lookupShadowParamsInactiveWindows(g_shadowSizeEnumInactiveWindows);
+        const CompositeShadowParams params = lookupShadowParams(key.size);
 
         if (params.isNone())
         {
-            g_sShadow.reset();
-            setShadow(g_sShadow);
+            insertShadow(key, nullptr);
+            setShadow(nullptr);
             return;
         }
 
-        auto withOpacity = [](const QColor &color, qreal opacity) -> QColor
+        // the texture may have been rendered by an earlier session already
+        if (const ShadowTexture texture = ShadowAtlas::self()->texture(key); !texture.isNull())
         {
-            QColor c(color);
-            c.setAlphaF(opacity);
-            return c;
-        };
-
-        const auto s = settings();
-
-        const QSize boxSize = BoxShadowRenderer::calculateMinimumBoxSize(2 * s->smallSpacing() * params.shadow1.radius)
-                                  .expandedTo(BoxShadowRenderer::calculateMinimumBoxSize(2 * s->smallSpacing() * params.shadow2.radius));
-
-        BoxShadowRenderer shadowRenderer;
-        shadowRenderer.setBorderRadius(0.5 * s->smallSpacing() * (m_internalSettings->cornerRadius() + 0.5));
-        shadowRenderer.setBoxSize(boxSize);
-
-        const qreal strength = static_cast<qreal>(g_shadowStrengthInactiveWindows) / 255.0;
-        shadowRenderer.addShadow(params.shadow1.offset, params.shadow1.radius,
-                                 withOpacity(g_shadowColorInactiveWindows, params.shadow1.opacity * strength));
-        shadowRenderer.addShadow(params.shadow2.offset, params.shadow2.radius,
-                                 withOpacity(g_shadowColorInactiveWindows, params.shadow2.opacity * strength));
-
-        QImage shadowTexture = shadowRenderer.render();
-
-        QPainter painter(&shadowTexture);
-        painter.setRenderHint(QPainter::Antialiasing);
-
-        const QRect outerRect = shadowTexture.rect();
-
-        QRect boxRect(QPoint(0, 0), boxSize);
-        boxRect.moveCenter(outerRect.center());
-
-        // Mask out inner rect.
-        const QMargins padding = QMargins(
-            boxRect.left() - outerRect.left() - Metrics::Shadow_Overlap - params.offset.x(),
-            boxRect.top() - outerRect.top() - Metrics::Shadow_Overlap - params.offset.y(),
-            outerRect.right() - boxRect.right() - Metrics::Shadow_Overlap + params.offset.x(),
-            outerRect.bottom() - boxRect.bottom() - Metrics::Shadow_Overlap + params.offset.y());
-        const QRect innerRect = outerRect - padding;
-
-        painter.setPen(Qt::NoPen);
-        painter.setBrush(Qt::black);
-        painter.setCompositionMode(QPainter::CompositionMode_DestinationOut);
-        painter.drawRoundedRect(
-            innerRect,
-            0.5 * s->smallSpacing() * (m_internalSettings->cornerRadius() + 0.5),
-            0.5 * s->smallSpacing() * (m_internalSettings->cornerRadius() + 0.5));
+            auto shadow = createShadowObject(texture);
+            insertShadow(key, shadow);
+            setShadow(shadow);
+            return;
+        }
 
-        // Draw outline.
-        // painter.setPen(withOpacity(g_shadowColorInactiveWindows, 0.2 * strength));
-        // painter.setBrush(Qt::NoBrush);
-        // painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
-        // painter.drawRoundedRect(
-        //     innerRect,
-        //     0.5*s->smallSpacing()*(m_internalSettings->cornerRadius() - 0.5),
-        //     0.5*s->smallSpacing()*(m_internalSettings->cornerRadius() - 0.5));
+        // nothing to show in the meantime, so render right away
+        if (!shadow())
+        {
+            setShadow(storeShadow(key, renderShadowTexture(key, params)));
+            return;
+        }
 
-        painter.end();
+        // keep showing the current shadow until the new one is ready
+        auto watcher = new QFutureWatcher<ShadowTexture>(this);
+        connect(watcher, &QFutureWatcherBase::finished, this, [this, watcher, key]()
+                {
+                    watcher->deleteLater();
 
-        g_sShadow = std::make_shared<KDecoration3::DecorationShadow>();
-        g_sShadow->setPadding(padding);
-        g_sShadow->setInnerShadowRect(QRect(outerRect.center(), QSize(1, 1)));
-        g_sShadow->setShadow(shadowTexture);
+                    // the first decoration to get the result stores it for everybody
+                    if (g_pendingShadows.remove(key))
+                        storeShadow(key, watcher->result());
 
-        setShadow(g_sShadow);
+                    // settings may have changed again meanwhile
+                    updateShadow();
+                });
+        watcher->setFuture(renderShadowTextureAsync(key, params));
     }
 
     //________________________________________________________________
@@ -717,6 +749,9 @@ namespace Breeze
     {
 
         m_internalSettings = SettingsProvider::self()->internalSettings(this);
+        invalidateColors();
+        invalidateTitleBarBackground();
+        invalidateCaption();
 
         // animation
         m_animation->setDuration(m_internalSettings->animationsDuration());
@@ -802,67 +837,141 @@ namespace Breeze
             setBlurRegion(QRegion());
         }
         else
-        {                                           // transparent titlebar colours
-            calculateWindowAndTitleBarShapes(true); // refreshes m_windowPath
-            setBlurRegion(QRegion(m_windowPath->toFillPolygon().toPolygon()));
+        { // transparent titlebar colours
+            setBlurRegion(windowShape());
         }
+
+        // let the compositor skip blending when neither colors nor rounded corners let anything through
+        const auto s = settings();
+        const bool roundedCorners = s->isAlphaChannelSupported() && !isMaximized() && m_internalSettings->cornerRadius() > 0;
+        setOpaque(titleBarAlpha() == 255 && this->titleBarColor().alpha() == 255 && !roundedCorners);
     }
 
-    void Decoration::calculateWindowAndTitleBarShapes(const bool windowShapeOnly)
+    //________________________________________________________________
+    QRegion Decoration::windowShape() const
     {
         auto c = window();
         Q_ASSERT(c);
         auto s = settings();
 
-        if (!windowShapeOnly || c->isShaded())
+        const qreal radius = 0.5 * s->smallSpacing() * m_internalSettings->cornerRadius();
+
+        // a shaded window is reduced to its title bar, rounded on all sides
+        if (c->isShaded())
         {
-            // set titleBar geometry and path
-            m_titleRect = QRect(QPoint(0, 0), QSize(size().width(), borderTop()));
-            m_titleBarPath->clear(); // clear the path for subsequent calls to this function
+            const QRect titleRect(QPoint(0, 0), QSize(size().width(), borderTop()));
             if (isMaximized() || !s->isAlphaChannelSupported())
-            {
-                m_titleBarPath->addRect(m_titleRect);
-            }
-            else if (c->isShaded())
-            {
-                m_titleBarPath->addRoundedRect(m_titleRect, 0.5 * s->smallSpacing() * m_internalSettings->cornerRadius(), 0.5 * s->smallSpacing() * m_internalSettings->cornerRadius());
-            }
+                return QRegion(titleRect);
             else
+                return roundedRegion(titleRect, radius);
+        }
+
+        if (s->isAlphaChannelSupported() && !isMaximized())
+            return roundedRegion(rect(), radius);
+        else
+            return QRegion(rect());
+    }
+
+    //________________________________________________________________
+    QRegion Decoration::roundedRegion(const QRect &rect, qreal radius) const
+    {
+        // nothing to round, a single rect does
+        if (radius <= 0)
+            return QRegion(rect);
+
+        // the corner steps only depend on radius and tolerance, the window size only changes where they go
+        const int tolerance = m_internalSettings->blurCornerTolerance();
+        if (m_corners.radius != radius || m_corners.tolerance != tolerance)
+        {
+            m_corners.radius = radius;
+            m_corners.tolerance = tolerance;
+            m_corners.extent = qCeil(radius);
+            m_corners.steps.clear();
+
+            // rows from the outer edge inwards. Rows whose inset is within tolerance of the first one
+            // share a rect, which uses the largest inset so that the region never leaves the rounded shape
+            auto inset = [radius](int row) -> int
             {
-                QPainterPath clipRect;
-                clipRect.addRect(m_titleRect);
-
-                // the rect is made a little bit larger to be able to clip away the rounded corners at the bottom and sides
-                m_titleBarPath->addRoundedRect(m_titleRect.adjusted(
-                                                   isLeftEdge() ? -0.5 * s->smallSpacing() * m_internalSettings->cornerRadius() : 0,
-                                                   isTopEdge() ? -0.5 * s->smallSpacing() * m_internalSettings->cornerRadius() : 0,
-                                                   isRightEdge() ? 0.5 * s->smallSpacing() * m_internalSettings->cornerRadius() : 0,
-                                                   0.5 * s->smallSpacing() * m_internalSettings->cornerRadius()),
-                                               0.5 * s->smallSpacing() * m_internalSettings->cornerRadius(), 0.5 * s->smallSpacing() * m_internalSettings->cornerRadius());
-
-                *m_titleBarPath = m_titleBarPath->intersected(clipRect);
+                const qreal dy = radius - row;
+                return qCeil(radius - std::sqrt(qMax<qreal>(0, radius * radius - dy * dy)));
+            };
+
+            for (int row = 0; row < m_corners.extent;)
+            {
+                const int stepInset = inset(row);
+                int height = 1;
+                while (row + height < m_corners.extent && stepInset - inset(row + height) <= tolerance)
+                    ++height;
+
+                m_corners.steps.append({height, stepInset});
+                row += height;
             }
         }
 
-        // set windowPath
-        m_windowPath->clear(); // clear the path for subsequent calls to this function
-        if (!c->isShaded())
+        // corners would overlap
+        const int extent = m_corners.extent;
+        if (rect.width() < 2 * extent || rect.height() < 2 * extent)
         {
-            if (s->isAlphaChannelSupported() && !isMaximized())
-                m_windowPath->addRoundedRect(rect(), 0.5 * s->smallSpacing() * m_internalSettings->cornerRadius(), 0.5 * s->smallSpacing() * m_internalSettings->cornerRadius());
-            else
-                m_windowPath->addRect(rect());
+            QPainterPath path;
+            path.addRoundedRect(rect, radius, radius);
+            return QRegion(path.toFillPolygon().toPolygon());
         }
-        else
+
+        // the steps at the top, one full width rect between the corners, and the steps mirrored at the bottom.
+        // QRegion::setRects() expects them sorted from top to bottom
+        QList<QRect> rects;
+        rects.reserve(2 * m_corners.steps.size() + 1);
+
+        int y = rect.y();
+        for (const auto &step : std::as_const(m_corners.steps))
+        {
+            rects.append(QRect(rect.x() + step.inset, y, rect.width() - 2 * step.inset, step.height));
+            y += step.height;
+        }
+
+        rects.append(QRect(rect.x(), y, rect.width(), rect.height() - 2 * extent));
+        y += rect.height() - 2 * extent;
+
+        for (auto it = m_corners.steps.crbegin(); it != m_corners.steps.crend(); ++it)
         {
-            *m_windowPath = *m_titleBarPath;
+            rects.append(QRect(rect.x() + it->inset, y, rect.width() - 2 * it->inset, it->height));
+            y += it->height;
         }
+
+        // drop the empty middle rect of windows exactly as high as their corners
+        rects.removeIf([](const QRect &r) { return r.isEmpty(); });
+
+        QRegion region;
+        region.setRects(rects.constData(), rects.size());
+        return region;
     }
 
     //________________________________________________________________
     void Decoration::updateButtonsGeometryDelayed()
     {
-        QTimer::singleShot(0, this, &Decoration::updateButtonsGeometry);
+        scheduleUpdate(ButtonsGeometryUpdate);
+    }
+
+    //________________________________________________________________
+    void Decoration::scheduleUpdate(UpdateFlags flags)
+    {
+        // a resize emits several signals per step, the blur region is recomputed once for all of them
+        if (!m_pendingUpdates)
+            QTimer::singleShot(0, this, &Decoration::flushUpdates);
+
+        m_pendingUpdates |= flags;
+    }
+
+    //________________________________________________________________
+    void Decoration::flushUpdates()
+    {
+        const UpdateFlags flags = m_pendingUpdates;
+        m_pendingUpdates = {};
+
+        if (flags & ButtonsGeometryUpdate)
+            updateButtonsGeometry();
+        if (flags & BlurUpdate)
+            updateBlur();
     }
 
     //________________________________________________________________
@@ -931,23 +1040,39 @@ namespace Breeze
     //________________________________________________________________
     void Decoration::paint(QPainter *painter, const QRectF &repaintRegion)
     {
-        // TODO: optimize based on repaintRegion
         auto c = window();
         auto s = settings();
 
+        // the frame must not go out with the buttons or the blur region of an earlier geometry
+        if (m_pendingUpdates)
+            flushUpdates();
+
+        const QRectF frameRect(rect());
+        const QRectF dirtyRect = frameRect.intersected(repaintRegion);
+        if (dirtyRect.isEmpty())
+            return;
+
         QColor titleBarColor = this->titleBarColor();
+        const qreal cornerRadius = 0.5 * s->smallSpacing() * m_internalSettings->cornerRadius();
 
-        // paint background
-        if (!c->isShaded())
+        // no drawing step needs to touch anything outside of the dirty area
+        painter->save();
+        painter->setClipRect(dirtyRect, Qt::IntersectClip);
+
+        // paint background, limited to the border strips since the client covers the rest,
+        // and skipped when only the title bar is dirty
+        const QRect backgroundRect = hideTitleBar() ? rect() : rect().adjusted(0, borderTop(), 0, 0);
+        const QRect clientRect = rect().adjusted(borderLeft(), borderTop(), -borderRight(), -borderBottom());
+        const QRegion backgroundRegion = QRegion(backgroundRect) - QRegion(clientRect);
+        if (!c->isShaded() && backgroundRegion.intersects(dirtyRect.toAlignedRect()))
         {
-            painter->fillRect(rect(), Qt::transparent);
+            PaintProfiler::Scope profile(PaintProfiler::Background);
             painter->save();
             painter->setRenderHint(QPainter::Antialiasing);
             painter->setBrush(titleBarColor);
 
-            // clip away the top part
-            if (!hideTitleBar())
-                painter->setClipRect(0, borderTop(), size().width(), size().height() - borderTop(), Qt::IntersectClip);
+            // clip away the top part and the client area
+            painter->setClipRegion(backgroundRegion, Qt::IntersectClip);
 
             // When no borders set, outline will be drawn by shader
             QPen border_pen1;
@@ -959,7 +1084,7 @@ namespace Breeze
             painter->setPen(border_pen1);
             if (s->isAlphaChannelSupported())
             {
-                painter->drawRoundedRect(rect(), 0.5 * s->smallSpacing() * m_internalSettings->cornerRadius(), 0.5 * s->smallSpacing() * m_internalSettings->cornerRadius());
+                painter->drawRoundedRect(rect(), cornerRadius, cornerRadius);
             }
             else
             {
@@ -969,9 +1094,12 @@ namespace Breeze
             painter->restore();
         }
 
-        paintTitleBar(painter, repaintRegion);
+        // skipped when only the borders are dirty
+        paintTitleBar(painter, dirtyRect);
 
-        if (hasBorders())
+        // the outline only covers the edges and rounded corners of the frame
+        const qreal outlineWidth = qMax<qreal>(1, s->isAlphaChannelSupported() ? cornerRadius : 0);
+        if (hasBorders() && !frameRect.adjusted(outlineWidth, outlineWidth, -outlineWidth, -outlineWidth).contains(dirtyRect))
         {
             painter->save();
             // painter->setRenderHint(QPainter::Antialiasing, false);
@@ -980,12 +1108,14 @@ namespace Breeze
             QPen border_pen1(titleBarColor.darker(125));
             painter->setPen(border_pen1);
             if (s->isAlphaChannelSupported())
-                painter->drawRoundedRect(rect(), 0.5 * s->smallSpacing() * m_internalSettings->cornerRadius(), 0.5 * s->smallSpacing() * m_internalSettings->cornerRadius());
+                painter->drawRoundedRect(rect(), cornerRadius, cornerRadius);
             else
                 painter->drawRect(rect());
 
             painter->restore();
         }
+
+        painter->restore();
     }
 
     //________________________________________________________________
@@ -996,75 +1126,191 @@ namespace Breeze
             return;
 
         auto c = window();
-        QColor outlineColor(this->outlineColor());
-        QColor titleBarColor = this->titleBarColor();
+        auto s = settings();
+
+        paintTitleBarBackground(painter, titleRect);
+
+        if (!hideTitleBar())
+        {
+            // draw all buttons
+            paintButtons(painter, repaintRegion);
+
+            // draw caption, unless only a button is dirty
+            const auto cR = captionRect();
+            if (cR.first.intersects(repaintRegion.toAlignedRect()))
+            {
+                PaintProfiler::Scope profile(PaintProfiler::Caption);
+
+                painter->setFont(s->font());
+                painter->setPen(fontColor());
+
+                // elide and lay out the caption again only if it no longer fits the way it did
+                if (m_caption.elidedWidth != cR.first.width())
+                {
+                    QString caption = s->fontMetrics().elidedText(c->caption(), Qt::ElideMiddle, cR.first.width());
+                    caption.replace(QLatin1Char('\n'), QLatin1Char(' '));
+
+                    m_caption.elidedWidth = cR.first.width();
+                    m_caption.text.setTextFormat(Qt::PlainText);
+                    m_caption.text.setText(caption);
+                    m_caption.text.prepare(QTransform(), s->font());
+                }
+
+                // place the text the way drawText() aligns a single line, which goes by the font
+                // height rather than QStaticText::size(), as that includes the leading
+                const QSizeF textSize = m_caption.text.size();
+                const qreal lineHeight = s->fontMetrics().height();
+                QPointF position(cR.first.left(), cR.first.top());
+                if (cR.second & Qt::AlignBottom)
+                    position.setY(cR.first.bottom() + 1 - lineHeight);
+                else if (cR.second & Qt::AlignVCenter)
+                    position.setY(cR.first.top() + (cR.first.height() - lineHeight) / 2);
+
+                if (cR.second & Qt::AlignRight)
+                    position.setX(cR.first.right() + 1 - textSize.width());
+                else if (cR.second & Qt::AlignHCenter)
+                    position.setX(cR.first.left() + (cR.first.width() - textSize.width()) / 2);
+
+                painter->drawStaticText(position, m_caption.text);
+            }
+        }
+    }
+
+    //________________________________________________________________
+    void Decoration::paintButtons(QPainter *painter, const QRectF &repaintRegion)
+    {
+        // buttons share the painter state set up here, and their sprites are collected
+        // from both groups so that the transform is reset only once for all of them
+        QList<Button::Blit> blits;
+        for (auto group : {m_leftButtons, m_rightButtons})
+        {
+            const auto buttons = group->buttons();
+            for (auto button : buttons)
+            {
+                if (button->isVisible())
+                    static_cast<Button *>(button)->paintBatched(painter, repaintRegion, blits);
+            }
+        }
+
+        if (blits.isEmpty())
+            return;
 
         painter->save();
-        painter->setPen(Qt::NoPen);
+        painter->resetTransform();
+        for (const Button::Blit &blit : std::as_const(blits))
+            painter->drawImage(blit.position, blit.image);
+        painter->restore();
+    }
 
-        // render a linear gradient on title area
+    //________________________________________________________________
+    void Decoration::paintTitleBarBackground(QPainter *painter, const QRectF &titleRect)
+    {
+        PaintProfiler::Scope profile(PaintProfiler::TitleBar);
+
+        auto c = window();
+        auto s = settings();
+
+        // everything the background depends on
+        TitleBarBackgroundKey key;
+        key.size = titleRect.size().toSize();
+        key.devicePixelRatio = painter->device()->devicePixelRatioF();
+        key.color = this->titleBarColor().rgba();
+        key.outlineColor = !c->isShaded() && !hideTitleBar() && outlineColor().isValid() ? outlineColor().rgba() : 0;
+        key.gradient = -1;
         if (drawBackgroundGradient())
         {
-            QLinearGradient gradient(0, 0, 0, titleRect.height());
             int b = m_internalSettings->gradientOverride() > -1 ? m_internalSettings->gradientOverride() : m_internalSettings->backgroundGradientIntensity();
             if (!c->isActive())
                 b *= 0.5;
-            b = qBound(0, b, 100);
-            gradient.setColorAt(0.0, titleBarColor.lighter(100 + b));
+            key.gradient = qBound(0, b, 100);
+        }
+        key.cornerRadius = m_internalSettings->cornerRadius();
+        key.edges = (isLeftEdge() ? Qt::LeftEdge : Qt::Edges()) | (isTopEdge() ? Qt::TopEdge : Qt::Edges()) | (isRightEdge() ? Qt::RightEdge : Qt::Edges());
+        key.borderSize = borderSize();
+        key.hasBorders = hasBorders();
+        key.alphaChannelSupported = s->isAlphaChannelSupported();
+        key.antialiasing = painter->testRenderHint(QPainter::Antialiasing);
+
+        if (m_titleBarBackground.isNull() || key != m_titleBarBackgroundKey)
+        {
+            m_titleBarBackgroundKey = key;
+            m_titleBarBackground = renderTitleBarBackground(key);
+        }
+
+        painter->drawImage(titleRect.topLeft(), m_titleBarBackground);
+    }
+
+    //________________________________________________________________
+    QImage Decoration::renderTitleBarBackground(const TitleBarBackgroundKey &key) const
+    {
+        // round up, a truncated image leaves a seam along the bottom and right at fractional scales
+        const QSize deviceSize(qCeil(key.size.width() * key.devicePixelRatio), qCeil(key.size.height() * key.devicePixelRatio));
+        QImage image(deviceSize, QImage::Format_ARGB32_Premultiplied);
+        image.setDevicePixelRatio(key.devicePixelRatio);
+        image.fill(Qt::transparent);
+
+        const QRectF titleRect(QPoint(0, 0), key.size);
+        const QColor titleBarColor = QColor::fromRgba(key.color);
+
+        QPainter painter(&image);
+        painter.setRenderHint(QPainter::Antialiasing, key.antialiasing);
+        painter.setPen(Qt::NoPen);
+
+        // render a linear gradient on title area
+        if (key.gradient >= 0)
+        {
+            QLinearGradient gradient(0, 0, 0, titleRect.height());
+            gradient.setColorAt(0.0, titleBarColor.lighter(100 + key.gradient));
             gradient.setColorAt(1.0, titleBarColor);
-            painter->setBrush(gradient);
+            painter.setBrush(gradient);
         }
         else
-            painter->setBrush(titleBarColor);
+            painter.setBrush(titleBarColor);
 
-        auto s = settings();
-        if (!s->isAlphaChannelSupported())
-            painter->drawRect(titleRect);
-        else if (!hasBorders())
+        if (!key.alphaChannelSupported)
+            painter.drawRect(titleRect);
+        else if (!key.hasBorders)
         {
-            painter->setClipRect(titleRect, Qt::IntersectClip);
-            // the rect is made a little bit larger to be able to clip away the rounded corners at the bottom and sides
+            // the rect is made a little bit larger to be able to clip away the rounded corners at the bottom and sides,
+            // the image itself does the clipping
             QRectF adjustetTitleRect = titleRect.adjusted(
-                isLeftEdge() ? -m_internalSettings->cornerRadius() : 0,
-                isTopEdge() ? -m_internalSettings->cornerRadius() : 0,
-                isRightEdge() ? m_internalSettings->cornerRadius() : 0,
-                m_internalSettings->cornerRadius());
+                key.edges.testFlag(Qt::LeftEdge) ? -key.cornerRadius : 0,
+                key.edges.testFlag(Qt::TopEdge) ? -key.cornerRadius : 0,
+                key.edges.testFlag(Qt::RightEdge) ? key.cornerRadius : 0,
+                key.cornerRadius);
 
-            painter->drawRoundedRect(adjustetTitleRect, m_internalSettings->cornerRadius(), m_internalSettings->cornerRadius());
+            painter.drawRoundedRect(adjustetTitleRect, key.cornerRadius, key.cornerRadius);
         }
         else
         {
-            painter->drawRoundedRect(titleRect, m_internalSettings->cornerRadius(), m_internalSettings->cornerRadius());
+            painter.drawRoundedRect(titleRect, key.cornerRadius, key.cornerRadius);
         }
 
-        if (!c->isShaded() && !hideTitleBar() && outlineColor.isValid())
+        if (key.outlineColor)
         {
             // outline
-            painter->setRenderHint(QPainter::Antialiasing, false);
-            painter->setBrush(Qt::NoBrush);
-            QPen pen(outlineColor);
+            painter.setRenderHint(QPainter::Antialiasing, false);
+            painter.setBrush(Qt::NoBrush);
+            QPen pen(QColor::fromRgba(key.outlineColor));
             pen.setWidth(1);
-            painter->setPen(pen);
-            painter->drawLine(titleRect.bottomLeft() + QPoint(borderSize(), 0), titleRect.bottomRight() - QPoint(borderSize(), 0));
+            painter.setPen(pen);
+            painter.drawLine(titleRect.bottomLeft() + QPoint(key.borderSize, 0), titleRect.bottomRight() - QPoint(key.borderSize, 0));
         }
 
-        painter->restore();
-
-        if (!hideTitleBar())
-        {
-            // draw all buttons
-            m_leftButtons->paint(painter, repaintRegion);
-            m_rightButtons->paint(painter, repaintRegion);
-
-            // draw caption
+        return image;
+    }
 
-            painter->setFont(s->font());
-            painter->setPen(fontColor());
+    //________________________________________________________________
+    void Decoration::invalidateTitleBarBackground()
+    {
+        m_titleBarBackground = QImage();
+    }
 
-            const auto cR = captionRect();
-            const QString caption = painter->fontMetrics().elidedText(c->caption(), Qt::ElideMiddle, cR.first.width());
-            painter->drawText(cR.first, cR.second | Qt::TextSingleLine, caption);
-        }
+    //________________________________________________________________
+    void Decoration::invalidateCaption()
+    {
+        m_caption.boundingRect = QRect();
+        m_caption.elidedWidth = -1;
     }
 
     //________________________________________________________________
@@ -1134,7 +1380,9 @@ namespace Breeze
 
                 // full caption rect
                 const QRect fullRect = QRect(0, yOffset, size().width(), captionHeight());
-                QRect boundingRect(settings()->fontMetrics().boundingRect(c->caption()).toRect());
+                if (!m_caption.boundingRect.isValid())
+                    m_caption.boundingRect = settings()->fontMetrics().boundingRect(c->caption()).toRect();
+                QRect boundingRect(m_caption.boundingRect);
 
                 // text bounding rect
                 boundingRect.setTop(yOffset);
@@ -1155,37 +1403,9 @@ namespace Breeze
     //________________________________________________________________
     void Decoration::createShadow()
     {
-        if (!g_sShadow)
-        {
-            g_shadowSizeEnum = m_internalSettings->shadowSize();
-            g_shadowStrength = m_internalSettings->shadowStrength();
-            g_shadowColor = m_internalSettings->shadowColor();
-            g_specificShadowsInactiveWindows = m_internalSettings->specificShadowsInactiveWindows();
-            g_shadowSizeEnumInactiveWindows = m_internalSettings->shadowSizeInactiveWindows();
-            g_shadowStrengthInactiveWindows = m_internalSettings->shadowStrengthInactiveWindows();
-            g_shadowColorInactiveWindows = m_internalSettings->shadowColorInactiveWindows();
-
-            updateShadow();
-        }
-        else if (g_shadowSizeEnum != m_internalSettings->shadowSize() || g_shadowStrength != m_internalSettings->shadowStrength() || g_shadowColor != m_internalSettings->shadowColor())
-        {
-            g_shadowSizeEnum = m_internalSettings->shadowSize();
-            g_shadowStrength = m_internalSettings->shadowStrength();
-            g_shadowColor = m_internalSettings->shadowColor();
-
-            updateActiveShadow();
-        }
-        else if (g_specificShadowsInactiveWindows != m_internalSettings->specificShadowsInactiveWindows() || g_shadowSizeEnumInactiveWindows != m_internalSettings->shadowSizeInactiveWindows() || g_shadowStrengthInactiveWindows != m_internalSettings->shadowStrengthInactiveWindows() || g_shadowColorInactiveWindows != m_internalSettings->shadowColorInactiveWindows())
-        {
-            g_specificShadowsInactiveWindows = m_internalSettings->specificShadowsInactiveWindows();
-            g_shadowSizeEnumInactiveWindows = m_internalSettings->shadowSizeInactiveWindows();
-            g_shadowStrengthInactiveWindows = m_internalSettings->shadowStrengthInactiveWindows();
-            g_shadowColorInactiveWindows = m_internalSettings->shadowColorInactiveWindows();
-
-            updateInactiveShadow();
-        }
-        else
-            updateShadow();
+        // shadows are cached by their parameters, so this only renders
+        // when no decoration has needed the resulting texture yet
+        updateShadow();
     }
 
     //_________________________________________________________________
@@ -24,12 +24,15 @@
 
 #include "breeze.h"
 #include "breezesettings.h"
+#include "breezeshadowatlas.h"
 
 #include <KDecoration3/Decoration>
 #include <KDecoration3/DecoratedWindow>
 #include <KDecoration3/DecorationSettings>
 
+#include <QImage>
 #include <QPalette>
+#include <QStaticText>
 #include <QVariant>
 #include <QVariantAnimation>
 #include <QPainterPath>
@@ -82,10 +85,33 @@ namespace Breeze
 
         //*@name colors
         //@{
-        QColor titleBarColor() const;
-        QColor outlineColor() const;
-        QColor rawTitleBarColor() const;
-        QColor fontColor() const;
+
+        //* colors derived from palette, settings and active state
+        struct Colors
+        {
+            QColor rawTitleBar;
+            QColor titleBar;
+            QColor outline;
+            QColor font;
+
+            //* whether dark symbols are the readable ones on the title bar
+            bool lightTitleBar = false;
+        };
+
+        //* colors for the current state, computed at most once per state change or animation step
+        const Colors &colors() const;
+
+        QColor titleBarColor() const
+        { return colors().titleBar; }
+
+        QColor outlineColor() const
+        { return colors().outline; }
+
+        QColor rawTitleBarColor() const
+        { return colors().rawTitleBar; }
+
+        QColor fontColor() const
+        { return colors().font; }
         //@}
 
         //*@name maximization modes
@@ -135,7 +161,11 @@ namespace Breeze
         void updateAnimationState();
         void updateSizeGripVisibility();
         void updateBlur();
+        void flushUpdates();
         void createShadow();
+        void invalidateColors();
+        void invalidateTitleBarBackground();
+        void invalidateCaption();
 
         private:
 
@@ -144,10 +174,52 @@ namespace Breeze
 
         void createButtons();
         void paintTitleBar(QPainter *painter, const QRectF &repaintRegion);
+        void paintButtons(QPainter *painter, const QRectF &repaintRegion);
+        void paintTitleBarBackground(QPainter *painter, const QRectF &titleRect);
+
+        //* everything the title bar background depends on
+        struct TitleBarBackgroundKey
+        {
+            QSize size;
+            qreal devicePixelRatio = 1.0;
+            QRgb color = 0;
+            QRgb outlineColor = 0;
+            int gradient = -1;
+            int cornerRadius = 0;
+            Qt::Edges edges;
+            int borderSize = 0;
+            bool hasBorders = false;
+            bool alphaChannelSupported = false;
+            bool antialiasing = false;
+
+            bool operator==(const TitleBarBackgroundKey &other) const = default;
+        };
+
+        //* render title bar background, gradient and bottom outline included
+        QImage renderTitleBarBackground(const TitleBarBackgroundKey &key) const;
+
+        //*@name deferred updates, coalesced until the next event loop iteration or paint
+        //@{
+        enum UpdateFlag
+        {
+            ButtonsGeometryUpdate = 1<<0,
+            BlurUpdate = 1<<1
+        };
+
+        Q_DECLARE_FLAGS(UpdateFlags, UpdateFlag)
+
+        void scheduleUpdate(UpdateFlags);
+        //@}
+
+        //* everything the shadow for the current active state depends on
+        ShadowKey shadowKey() const;
         void updateShadow();
-        void updateActiveShadow();
-        void updateInactiveShadow();
-        void calculateWindowAndTitleBarShapes(const bool windowShapeOnly=false);
+
+        //* window shape, used as blur region
+        QRegion windowShape() const;
+
+        //* rect with rounded corners, as a compact set of rects built from the cached corner steps
+        QRegion roundedRegion(const QRect &rect, qreal radius) const;
 
         //*@name border size
         //@{
@@ -178,13 +250,53 @@ namespace Breeze
         //* active state change opacity
         qreal m_opacity = 0;
 
-        //* Rectangular area of titlebar without clipped corners
-        QRect m_titleRect;
-        
-        //* Exact titlebar path, with clipped rounded corners
-        std::shared_ptr<QPainterPath> m_titleBarPath = std::make_shared<QPainterPath>();
-        //* Exact window path, with clipped rounded corners
-        std::shared_ptr<QPainterPath> m_windowPath = std::make_shared<QPainterPath>();
+        //* updates waiting for flushUpdates()
+        UpdateFlags m_pendingUpdates;
+
+        //* colors snapshot
+        Colors computeColors() const;
+        mutable Colors m_colors;
+        mutable bool m_colorsValid = false;
+
+        //* cached title bar background, and what it was rendered for
+        TitleBarBackgroundKey m_titleBarBackgroundKey;
+        QImage m_titleBarBackground;
+
+        //* caption layout, reused until the caption, font or available width change
+        struct CaptionCache
+        {
+            //* bounding rect of the full caption, used for AlignCenterFullWidth
+            QRect boundingRect;
+
+            //* width the caption was elided for, -1 if it needs to be laid out again
+            int elidedWidth = -1;
+
+            //* elided caption
+            QStaticText text;
+        };
+
+        mutable CaptionCache m_caption;
+
+        //* rounded corners approximated by a few stepped rects
+        struct CornerCache
+        {
+            qreal radius = -1;
+            int tolerance = -1;
+
+            //* rows covered by the corners
+            int extent = 0;
+
+            //* rows sharing the same horizontal inset, from the outer edge inwards
+            struct Step
+            {
+                int height;
+                int inset;
+            };
+
+            QList<Step> steps;
+        };
+
+        mutable CornerCache m_corners;
     };
 
     bool Decoration::hasBorders() const
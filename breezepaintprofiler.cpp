@@ -0,0 +1,124 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "breezepaintprofiler.h"
+
+#include <QLoggingCategory>
+
+#include <algorithm>
+#include <iterator>
+#include <vector>
+
+Q_LOGGING_CATEGORY(SIERRABREEZEENHANCED_PROFILE, "sierrabreezeenhanced.profile", QtInfoMsg)
+
+namespace
+{
+    //* interval between two dumps
+    const int s_dumpInterval = 10000;
+
+    const char *const s_stageNames[] = {
+        "background",
+        "title bar",
+        "caption",
+        "shadow render",
+        "button plasma",
+        "button gnome",
+        "button macSierra",
+        "button macDarkAurorae",
+        "button sbeSierra",
+        "button sbeSierraActive",
+        "button sbeSierraInactive",
+        "button sbeDarkAurorae",
+        "button sbeDarkAuroraeActive",
+        "button sbeDarkAuroraeInactive",
+        "button sierraColorSymbols",
+        "button darkAuroraeColorSymbols",
+        "button sierraMonochromeSymbols",
+        "button darkAuroraeMonochromeSymbols"
+    };
+
+    static_assert(std::size(s_stageNames) == Breeze::PaintProfiler::StageCount);
+}
+
+namespace Breeze
+{
+
+    //__________________________________________________________________
+    PaintProfiler::PaintProfiler()
+    {
+        m_timer.setInterval( s_dumpInterval );
+        connect( &m_timer, &QTimer::timeout, this, &PaintProfiler::dump );
+
+        // nothing to report unless profiling was requested
+        if( enabled() ) m_timer.start();
+    }
+
+    //__________________________________________________________________
+    bool PaintProfiler::enabled()
+    {
+        static const bool enabled = qEnvironmentVariableIntValue( "SIERRABREEZEENHANCED_PROFILE" ) > 0;
+        return enabled;
+    }
+
+    //__________________________________________________________________
+    PaintProfiler *PaintProfiler::self()
+    {
+        static PaintProfiler profiler;
+        return &profiler;
+    }
+
+    //__________________________________________________________________
+    void PaintProfiler::record( int stage, qint64 nsecs )
+    {
+        if( stage < 0 || stage >= StageCount ) return;
+
+        Samples &samples( m_samples[stage] );
+        const quint32 index = samples.count.fetch_add( 1, std::memory_order_relaxed ) % SampleCount;
+        samples.values[index].store( nsecs, std::memory_order_relaxed );
+    }
+
+    //__________________________________________________________________
+    void PaintProfiler::dump() const
+    {
+        std::vector<qint64> values;
+        values.reserve( SampleCount );
+
+        for( int stage = 0; stage < StageCount; ++stage )
+        {
+
+            // only report stages that ran since the last dump
+            const quint32 count = m_samples[stage].count.load( std::memory_order_relaxed );
+            if( count == m_reported[stage] ) continue;
+            m_reported[stage] = count;
+
+            values.clear();
+            const quint32 size = std::min( count, SampleCount );
+            for( quint32 i = 0; i < size; ++i )
+            { values.push_back( m_samples[stage].values[i].load( std::memory_order_relaxed ) ); }
+
+            std::sort( values.begin(), values.end() );
+            const qint64 p50 = values[ ( size - 1 ) * 50 / 100 ];
+            const qint64 p99 = values[ ( size - 1 ) * 99 / 100 ];
+
+            qCInfo( SIERRABREEZEENHANCED_PROFILE ).nospace()
+                << s_stageNames[stage] << ": p50 " << p50/1000 << "us, p99 " << p99/1000 << "us, over the last " << size << " of " << count << " samples";
+
+        }
+    }
+
+}
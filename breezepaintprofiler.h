@@ -0,0 +1,118 @@
+#ifndef breezepaintprofiler_h
+#define breezepaintprofiler_h
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+
+#include <array>
+#include <atomic>
+
+namespace Breeze
+{
+
+    //* opt-in timing of the decoration paint stages, enabled with SIERRABREEZEENHANCED_PROFILE=1
+    class PaintProfiler: public QObject
+    {
+
+        Q_OBJECT
+
+        public:
+
+        //* number of button styles, see ButtonStyle in breezesettingsdata.kcfg
+        static constexpr int ButtonStyleCount = 14;
+
+        //* measured stages. Buttons are measured per style, starting at ButtonStyle
+        enum Stage
+        {
+            Background,
+            TitleBar,
+            Caption,
+            ShadowRender,
+            ButtonStyle,
+            StageCount = ButtonStyle + ButtonStyleCount
+        };
+
+        //* true if profiling was requested through the environment
+        static bool enabled();
+
+        //* singleton. Must first be called from the main thread.
+        //* It lives in the plugin's static storage, so that it is gone along with the plugin's code once KWin unloads it
+        static PaintProfiler *self();
+
+        //* record a duration. Safe to call from any thread
+        void record(int stage, qint64 nsecs);
+
+        //* records the time until it goes out of scope, if profiling is enabled
+        class Scope
+        {
+            public:
+
+            explicit Scope(int stage):
+                m_stage( enabled() ? stage : -1 )
+            { if( m_stage >= 0 ) m_timer.start(); }
+
+            ~Scope()
+            { if( m_stage >= 0 ) PaintProfiler::self()->record( m_stage, m_timer.nsecsElapsed() ); }
+
+            Scope(const Scope&) = delete;
+            Scope &operator=(const Scope&) = delete;
+
+            private:
+
+            int m_stage;
+            QElapsedTimer m_timer;
+
+        };
+
+        public Q_SLOTS:
+
+        //* log p50 and p99 of the samples recorded for each stage
+        void dump() const;
+
+        private:
+
+        //* constructor
+        PaintProfiler();
+
+        //* samples kept per stage
+        static constexpr quint32 SampleCount = 1024;
+
+        //* ring buffer of the latest samples of one stage
+        struct Samples
+        {
+            //* total number of samples recorded, the next one goes to index % SampleCount
+            std::atomic<quint32> count = 0;
+            std::array<std::atomic<qint64>, SampleCount> values = {};
+        };
+
+        std::array<Samples, StageCount> m_samples;
+
+        //* number of samples already reported, per stage
+        mutable std::array<quint32, StageCount> m_reported = {};
+
+        //* periodic dump
+        QTimer m_timer;
+
+    };
+
+}
+
+#endif
@@ -0,0 +1,207 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "breezeshadowatlas.h"
+
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <type_traits>
+
+#include <zlib.h>
+
+namespace
+{
+    // Bump the version whenever the layout below or the way shadows are rendered changes.
+    // Every version gets its own directory, so files are never replaced by ones of another layout.
+    const quint32 s_atlasMagic = 0x53424553; // "SBES"
+    const quint32 s_atlasVersion = 3;
+
+    //* pixel data starts at a multiple of this
+    const qint64 s_atlasAlignment = 16;
+
+    //* followed by the pixels
+    struct AtlasHeader
+    {
+        quint32 magic;
+        quint32 version;
+        qint32 size;
+        qint32 strength;
+        quint32 color;
+        qint32 cornerRadius;
+        qint32 smallSpacing;
+        qint32 reserved;
+        double devicePixelRatio;
+        qint32 padding[4];
+        qint32 innerShadowRect[4];
+        qint32 width;
+        qint32 height;
+        qint32 bytesPerLine;
+        quint32 checksum;
+    };
+
+    static_assert(std::is_trivially_copyable_v<AtlasHeader>);
+
+    inline qint64 align(qint64 value)
+    {
+        return (value + s_atlasAlignment - 1) / s_atlasAlignment * s_atlasAlignment;
+    }
+
+    const qint64 s_pixelOffset = align(sizeof(AtlasHeader));
+
+    //* CRC-32 of the pixels
+    quint32 checksum(const uchar *data, qint64 size)
+    {
+        uLong crc = crc32(0L, Z_NULL, 0);
+        while( size > 0 )
+        {
+            const uInt chunk = uInt( qMin<qint64>( size, std::numeric_limits<uInt>::max() ) );
+            crc = crc32( crc, data, chunk );
+            data += chunk;
+            size -= chunk;
+        }
+
+        return quint32( crc );
+    }
+
+    //* unmaps the pixels once the last copy of the image is gone
+    void closeAtlasFile(void *file)
+    { delete static_cast<QFile*>( file ); }
+
+    //* fills the header for given key and image, but the checksum
+    AtlasHeader atlasHeader(const Breeze::ShadowKey &key, const Breeze::ShadowTexture &texture, const QImage &image)
+    {
+        AtlasHeader header = {};
+        header.magic = s_atlasMagic;
+        header.version = s_atlasVersion;
+        header.size = key.size;
+        header.strength = key.strength;
+        header.color = key.color;
+        header.cornerRadius = key.cornerRadius;
+        header.smallSpacing = key.smallSpacing;
+        header.devicePixelRatio = key.devicePixelRatio;
+        header.padding[0] = texture.padding.left();
+        header.padding[1] = texture.padding.top();
+        header.padding[2] = texture.padding.right();
+        header.padding[3] = texture.padding.bottom();
+        header.innerShadowRect[0] = texture.innerShadowRect.x();
+        header.innerShadowRect[1] = texture.innerShadowRect.y();
+        header.innerShadowRect[2] = texture.innerShadowRect.width();
+        header.innerShadowRect[3] = texture.innerShadowRect.height();
+        header.width = image.width();
+        header.height = image.height();
+        header.bytesPerLine = image.bytesPerLine();
+        return header;
+    }
+}
+
+namespace Breeze
+{
+
+    //__________________________________________________________________
+    ShadowAtlas::ShadowAtlas():
+        m_directory( QStandardPaths::writableLocation( QStandardPaths::GenericCacheLocation ) + QStringLiteral("/sierrabreezeenhanced/shadows-%1").arg( s_atlasVersion ) )
+    {}
+
+    //__________________________________________________________________
+    ShadowAtlas *ShadowAtlas::self()
+    {
+        static ShadowAtlas atlas;
+        return &atlas;
+    }
+
+    //__________________________________________________________________
+    QString ShadowAtlas::fileName( const ShadowKey &key ) const
+    {
+        return QStringLiteral("%1/%2-%3-%4-%5-%6-%7.shadow")
+            .arg( m_directory )
+            .arg( key.size )
+            .arg( key.strength )
+            .arg( key.color, 8, 16, QLatin1Char('0') )
+            .arg( key.cornerRadius )
+            .arg( key.smallSpacing )
+            .arg( key.devicePixelRatio );
+    }
+
+    //__________________________________________________________________
+    ShadowTexture ShadowAtlas::texture( const ShadowKey &key ) const
+    {
+        // files are only ever replaced as a whole, a mapping never sees one change or shrink
+        auto file = std::make_unique<QFile>( fileName( key ) );
+        if( !file->open( QIODevice::ReadOnly ) || file->size() < s_pixelOffset ) return ShadowTexture();
+
+        const qint64 fileSize = file->size();
+        uchar *data = file->map( 0, fileSize );
+        if( !data ) return ShadowTexture();
+
+        AtlasHeader header;
+        std::memcpy( &header, data, sizeof(header) );
+
+        const ShadowKey stored{ header.size, header.strength, header.color, header.cornerRadius, header.smallSpacing, header.devicePixelRatio };
+        if( header.magic != s_atlasMagic || header.version != s_atlasVersion || stored != key ) return ShadowTexture();
+
+        const qint64 byteCount = qint64( header.height ) * header.bytesPerLine;
+        if( header.width <= 0 || header.height <= 0 || header.bytesPerLine < qint64( header.width ) * 4 || s_pixelOffset + byteCount != fileSize ) return ShadowTexture();
+
+        // the pixels are handed to the compositor as they are
+        const uchar *pixels = data + s_pixelOffset;
+        if( checksum( pixels, byteCount ) != header.checksum ) return ShadowTexture();
+
+        ShadowTexture texture;
+        texture.image = QImage( pixels, header.width, header.height, header.bytesPerLine, QImage::Format_ARGB32_Premultiplied, closeAtlasFile, file.release() );
+        texture.image.setDevicePixelRatio( key.devicePixelRatio );
+        texture.padding = QMargins( header.padding[0], header.padding[1], header.padding[2], header.padding[3] );
+        texture.innerShadowRect = QRect( header.innerShadowRect[0], header.innerShadowRect[1], header.innerShadowRect[2], header.innerShadowRect[3] );
+        return texture;
+    }
+
+    //__________________________________________________________________
+    void ShadowAtlas::insert( const ShadowKey &key, const ShadowTexture &texture )
+    {
+        if( texture.isNull() ) return;
+
+        QImage image( texture.image );
+        if( image.format() != QImage::Format_ARGB32_Premultiplied )
+        { image = image.convertToFormat( QImage::Format_ARGB32_Premultiplied ); }
+
+        m_writer.start( [directory = m_directory, fileName = fileName( key ), header = atlasHeader( key, texture, image ), image]() mutable
+        {
+            // another process may have written it already
+            if( QFile::exists( fileName ) ) return;
+
+            header.checksum = checksum( image.constBits(), image.sizeInBytes() );
+
+            // written next to the final file and renamed over it once complete,
+            // so that other processes only ever map whole files
+            QDir().mkpath( directory );
+            QSaveFile file( fileName );
+            if( !file.open( QIODevice::WriteOnly ) ) return;
+
+            file.write( reinterpret_cast<const char*>( &header ), sizeof(header) );
+            file.write( QByteArray( s_pixelOffset - qint64( sizeof(header) ), '\0' ) );
+            file.write( reinterpret_cast<const char*>( image.constBits() ), image.sizeInBytes() );
+            file.commit();
+        } );
+    }
+
+}
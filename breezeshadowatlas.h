@@ -0,0 +1,93 @@
+#ifndef breezeshadowatlas_h
+#define breezeshadowatlas_h
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of
+ * the License or (at your option) version 3 or any later version
+ * accepted by the membership of KDE e.V. (or its successor approved
+ * by the membership of KDE e.V.), which shall act as a proxy
+ * defined in Section 14 of version 3 of the license.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <QColor>
+#include <QHash>
+#include <QImage>
+#include <QMargins>
+#include <QRect>
+#include <QThreadPool>
+
+namespace Breeze
+{
+
+    //* everything a shadow texture depends on
+    struct ShadowKey
+    {
+        int size = 0;
+        int strength = 0;
+        QRgb color = 0;
+        int cornerRadius = 0;
+        int smallSpacing = 0;
+        qreal devicePixelRatio = 1.0;
+
+        bool operator==(const ShadowKey &other) const = default;
+    };
+
+    inline size_t qHash(const ShadowKey &key, size_t seed = 0)
+    {
+        return qHashMulti(seed, key.size, key.strength, key.color, key.cornerRadius, key.smallSpacing, key.devicePixelRatio);
+    }
+
+    //* a rendered shadow, with the nine-patch geometry KWin needs
+    struct ShadowTexture
+    {
+        QImage image;
+        QMargins padding;
+        QRect innerShadowRect;
+
+        bool isNull() const
+        { return image.isNull(); }
+    };
+
+    //* shadow textures persisted as memory mapped files, so they survive KWin restarts
+    class ShadowAtlas
+    {
+
+        public:
+
+        //* singleton. Destroyed when KWin unloads the plugin, which waits for pending writes
+        static ShadowAtlas *self();
+
+        //* persisted texture for given key, null if there is none
+        ShadowTexture texture(const ShadowKey &) const;
+
+        //* persist texture for given key. The file is written in the background
+        void insert(const ShadowKey &, const ShadowTexture &);
+
+        private:
+
+        //* constructor
+        ShadowAtlas();
+
+        //* file holding the texture for given key
+        QString fileName(const ShadowKey &) const;
+
+        //* directory of this version of the atlas
+        QString m_directory;
+
+        //* writes textures off the main thread
+        QThreadPool m_writer;
+
+    };
+
+}
+
+#endif
@@ -0,0 +1,63 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "allocationcounter.h"
+
+#include <atomic>
+#include <cstdlib>
+
+namespace
+{
+std::atomic<quint64> s_count{0};
+std::atomic<quint64> s_bytes{0};
+
+inline void record(size_t size)
+{
+    s_count.fetch_add(1, std::memory_order_relaxed);
+    s_bytes.fetch_add(size, std::memory_order_relaxed);
+}
+}
+
+#if defined(__GLIBC__)
+// glibc lets a program replace its allocator by defining these four,
+// forwarding to the original ones keeps everything else untouched.
+extern "C" {
+void *__libc_malloc(size_t size);
+void *__libc_calloc(size_t count, size_t size);
+void *__libc_realloc(void *pointer, size_t size);
+void __libc_free(void *pointer);
+
+void *malloc(size_t size) noexcept
+{
+    record(size);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) noexcept
+{
+    record(count * size);
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *pointer, size_t size) noexcept
+{
+    record(size);
+    return __libc_realloc(pointer, size);
+}
+
+void free(void *pointer) noexcept
+{
+    __libc_free(pointer);
+}
+}
+#endif
+
+namespace Breeze
+{
+AllocationCounter::Result AllocationCounter::current()
+{
+    return {s_count.load(std::memory_order_relaxed), s_bytes.load(std::memory_order_relaxed)};
+}
+
+} // namespace Breeze
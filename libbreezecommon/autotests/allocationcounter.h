@@ -0,0 +1,52 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#pragma once
+
+#include <QDebug>
+#include <QtGlobal>
+
+namespace Breeze
+{
+/**
+ * Counts heap allocations made by the process, QImage buffers included.
+ *
+ * Allocations are only seen on glibc, where malloc and friends are
+ * replaced by counting wrappers. Elsewhere all counts stay at zero.
+ **/
+class AllocationCounter
+{
+public:
+    struct Result {
+        quint64 count = 0;
+        quint64 bytes = 0;
+    };
+
+    /**
+     * Run @p function once and count what it allocates.
+     **/
+    template<typename Function>
+    static Result measure(Function function)
+    {
+        const Result before = current();
+        function();
+        const Result after = current();
+        return {after.count - before.count, after.bytes - before.bytes};
+    }
+
+    /**
+     * Run @p function once and log what it allocates, next to the timings QBENCHMARK reports.
+     **/
+    template<typename Function>
+    static void report(Function function)
+    {
+        const Result result = measure(function);
+        qInfo().nospace() << "allocations per iteration: " << result.count << " (" << result.bytes << " bytes)";
+    }
+
+private:
+    static Result current();
+};
+
+} // namespace Breeze
@@ -0,0 +1,315 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+// Shadow generation cost for every shadow size the decoration offers.
+// QBENCHMARK reports the time per iteration, each row also logs what a
+// single iteration allocates. Run with -tickcounter for CPU ticks.
+
+#include "allocationcounter.h"
+#include "breezeboxshadowrenderer.h"
+#include "breezeboxshadowrenderer_p.h"
+
+#include <QPainter>
+#include <QTest>
+
+#include <cmath>
+#include <iterator>
+#include <utility>
+
+using namespace Breeze;
+
+Q_DECLARE_METATYPE(BoxShadowRenderer::Engine)
+
+namespace
+{
+struct ShadowParams {
+    QPoint offset;
+    int radius;
+    qreal opacity;
+};
+
+struct ShadowPreset {
+    const char *name;
+    ShadowParams shadow1;
+    ShadowParams shadow2;
+};
+
+// Same as s_shadowParams in breezedecoration.cpp
+const ShadowPreset s_shadowPresets[] = {
+    {"none", {QPoint(0, 0), 0, 0}, {QPoint(0, 0), 0, 0}},
+    {"small", {QPoint(0, 0), 16, 1}, {QPoint(0, -2), 8, 0.4}},
+    {"medium", {QPoint(0, 0), 32, 0.9}, {QPoint(0, -4), 16, 0.3}},
+    {"large", {QPoint(0, 0), 48, 0.8}, {QPoint(0, -6), 24, 0.2}},
+    {"verylarge", {QPoint(0, 0), 64, 0.7}, {QPoint(0, -8), 32, 0.1}},
+};
+
+const qreal s_devicePixelRatios[] = {1.0, 1.5, 2.0};
+
+// A typical corner radius setting, in units of smallSpacing
+const int s_cornerRadius = 3;
+
+qreal shadowCornerRadius(int smallSpacing)
+{
+    return 0.5 * smallSpacing * (s_cornerRadius + 0.5);
+}
+
+// Box size, as picked by the decoration
+QSize shadowBoxSize(const ShadowPreset &preset, int smallSpacing)
+{
+    const qreal cornerRadius = shadowCornerRadius(smallSpacing);
+    return BoxShadowRenderer::calculateMinimumBoxSize(preset.shadow1.radius, cornerRadius)
+        .expandedTo(BoxShadowRenderer::calculateMinimumBoxSize(preset.shadow2.radius, cornerRadius));
+}
+
+// The layers render() stacks, on a canvas of the size render() picks
+QList<BoxShadowInternal::ShadowLayer> shadowLayers(const ShadowPreset &preset, int smallSpacing, qreal dpr, QImage &canvas)
+{
+    const QSize boxSize = shadowBoxSize(preset, smallSpacing);
+    const QSizeF canvasSize = BoxShadowRenderer::calculateMinimumShadowTextureSize(boxSize, preset.shadow1.radius, preset.shadow1.offset)
+                                  .expandedTo(BoxShadowRenderer::calculateMinimumShadowTextureSize(boxSize, preset.shadow2.radius, preset.shadow2.offset));
+    canvas = QImage((canvasSize * dpr).toSize(), QImage::Format_ARGB32_Premultiplied);
+
+    QList<BoxShadowInternal::ShadowLayer> layers;
+    for (const ShadowParams &shadow : {preset.shadow1, preset.shadow2}) {
+        const QSize maskSize = BoxShadowInternal::calculateShadowMaskSize(boxSize, shadow.radius, dpr);
+
+        BoxShadowInternal::ShadowLayer layer;
+        layer.quadrant = BoxShadowInternal::renderShadowQuadrant(maskSize, boxSize, shadowCornerRadius(smallSpacing), shadow.radius, dpr);
+        layer.rect = QRect(QPoint(0, 0), maskSize);
+        layer.rect.moveCenter(canvas.rect().center() + (QPointF(shadow.offset) * dpr).toPoint());
+        layer.color = qPremultiply(qRgba(0, 0, 0, 255 * shadow.opacity));
+        layers.append(layer);
+    }
+
+    return layers;
+}
+
+// What stackLayers() replaced: tint every mask as ARGB and let QPainter composite them
+void stackLayersWithPainter(QImage &canvas, const QList<BoxShadowInternal::ShadowLayer> &layers)
+{
+    canvas.fill(Qt::transparent);
+
+    QPainter painter(&canvas);
+    for (const BoxShadowInternal::ShadowLayer &layer : layers) {
+        QImage quadrant(layer.quadrant);
+        quadrant.setDevicePixelRatio(1.0);
+
+        QImage mask(layer.rect.size(), QImage::Format_ARGB32_Premultiplied);
+        mask.fill(Qt::transparent);
+
+        const QPoint mirrored(layer.rect.width() - quadrant.width(), layer.rect.height() - quadrant.height());
+        QPainter maskPainter(&mask);
+        maskPainter.drawImage(QPoint(0, 0), quadrant);
+        maskPainter.drawImage(QPoint(mirrored.x(), 0), quadrant.mirrored(true, false));
+        maskPainter.drawImage(QPoint(0, mirrored.y()), quadrant.mirrored(false, true));
+        maskPainter.drawImage(mirrored, quadrant.mirrored(true, true));
+        maskPainter.setCompositionMode(QPainter::CompositionMode_SourceIn);
+        maskPainter.fillRect(mask.rect(), QColor::fromRgba(qUnpremultiply(layer.color)));
+        maskPainter.end();
+
+        painter.drawImage(layer.rect.topLeft(), mask);
+    }
+}
+
+void addShadowMatrix()
+{
+    QTest::addColumn<int>("preset");
+    QTest::addColumn<int>("smallSpacing");
+    QTest::addColumn<qreal>("devicePixelRatio");
+
+    for (int preset = 0; preset < int(std::size(s_shadowPresets)); ++preset) {
+        for (int smallSpacing = 2; smallSpacing <= 8; ++smallSpacing) {
+            for (const qreal dpr : s_devicePixelRatios) {
+                QTest::addRow("%s spacing %d dpr %g", s_shadowPresets[preset].name, smallSpacing, dpr) << preset << smallSpacing << dpr;
+            }
+        }
+    }
+}
+
+// Same matrix, once per engine
+void addEngineShadowMatrix()
+{
+    QTest::addColumn<BoxShadowRenderer::Engine>("engine");
+    QTest::addColumn<int>("preset");
+    QTest::addColumn<int>("smallSpacing");
+    QTest::addColumn<qreal>("devicePixelRatio");
+
+    const std::pair<BoxShadowRenderer::Engine, const char *> engines[] = {
+        {BoxShadowRenderer::Engine::BoxBlur, "boxblur"},
+        {BoxShadowRenderer::Engine::Analytic, "analytic"},
+    };
+
+    for (const auto &[engine, engineName] : engines) {
+        for (int preset = 0; preset < int(std::size(s_shadowPresets)); ++preset) {
+            for (int smallSpacing = 2; smallSpacing <= 8; ++smallSpacing) {
+                for (const qreal dpr : s_devicePixelRatios) {
+                    QTest::addRow("%s %s spacing %d dpr %g", engineName, s_shadowPresets[preset].name, smallSpacing, dpr)
+                        << engine << preset << smallSpacing << dpr;
+                }
+            }
+        }
+    }
+}
+}
+
+class BoxShadowRendererBenchmark : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void render_data();
+    void render();
+    void boxBlurAlpha_data();
+    void boxBlurAlpha();
+    void renderShadowQuadrant_data();
+    void renderShadowQuadrant();
+    void stackLayers_data();
+    void stackLayers();
+    void stackLayersWithPainter_data();
+    void stackLayersWithPainter();
+};
+
+void BoxShadowRendererBenchmark::render_data()
+{
+    addEngineShadowMatrix();
+}
+
+void BoxShadowRendererBenchmark::render()
+{
+    QFETCH(BoxShadowRenderer::Engine, engine);
+    QFETCH(int, preset);
+    QFETCH(int, smallSpacing);
+    QFETCH(qreal, devicePixelRatio);
+
+    const ShadowPreset &params = s_shadowPresets[preset];
+
+    BoxShadowRenderer renderer(engine);
+    renderer.setBoxSize(shadowBoxSize(params, smallSpacing));
+    renderer.setBorderRadius(shadowCornerRadius(smallSpacing));
+    renderer.setDevicePixelRatio(devicePixelRatio);
+    renderer.addShadow(params.shadow1.offset, params.shadow1.radius, QColor(0, 0, 0, 255 * params.shadow1.opacity));
+    renderer.addShadow(params.shadow2.offset, params.shadow2.radius, QColor(0, 0, 0, 255 * params.shadow2.opacity));
+
+    AllocationCounter::report([&renderer] {
+        renderer.render();
+    });
+
+    QBENCHMARK {
+        renderer.render();
+    }
+}
+
+void BoxShadowRendererBenchmark::boxBlurAlpha_data()
+{
+    addShadowMatrix();
+}
+
+void BoxShadowRendererBenchmark::boxBlurAlpha()
+{
+    QFETCH(int, preset);
+    QFETCH(int, smallSpacing);
+    QFETCH(qreal, devicePixelRatio);
+
+    // the quadrant of the widest shadow, which is what render() blurs
+    const ShadowPreset &params = s_shadowPresets[preset];
+    const QSize maskSize = BoxShadowInternal::calculateShadowMaskSize(shadowBoxSize(params, smallSpacing), params.shadow1.radius, devicePixelRatio);
+
+    QImage quadrant((maskSize.width() + 1) / 2, (maskSize.height() + 1) / 2, QImage::Format_Alpha8);
+    quadrant.fill(Qt::transparent);
+
+    QPainter painter(&quadrant);
+    painter.fillRect(QRect(QPoint(quadrant.width() / 2, quadrant.height() / 2), quadrant.size()), Qt::black);
+    painter.end();
+
+    const int radius = std::round(params.shadow1.radius * devicePixelRatio);
+
+    AllocationCounter::report([&quadrant, radius] {
+        BoxShadowInternal::boxBlurAlpha(quadrant, radius);
+    });
+
+    QBENCHMARK {
+        BoxShadowInternal::boxBlurAlpha(quadrant, radius);
+    }
+}
+
+void BoxShadowRendererBenchmark::renderShadowQuadrant_data()
+{
+    addEngineShadowMatrix();
+}
+
+void BoxShadowRendererBenchmark::renderShadowQuadrant()
+{
+    QFETCH(BoxShadowRenderer::Engine, engine);
+    QFETCH(int, preset);
+    QFETCH(int, smallSpacing);
+    QFETCH(qreal, devicePixelRatio);
+
+    // rasterizing and blurring one quadrant replaced the full mask and its mirroring
+    const ShadowPreset &params = s_shadowPresets[preset];
+    const QSize boxSize = shadowBoxSize(params, smallSpacing);
+    const QSize maskSize = BoxShadowInternal::calculateShadowMaskSize(boxSize, params.shadow1.radius, devicePixelRatio);
+    const qreal cornerRadius = shadowCornerRadius(smallSpacing);
+    const int radius = params.shadow1.radius;
+
+    const auto renderQuadrant = engine == BoxShadowRenderer::Engine::Analytic ? BoxShadowInternal::renderAnalyticShadowQuadrant
+                                                                              : BoxShadowInternal::renderShadowQuadrant;
+
+    AllocationCounter::report([&] {
+        renderQuadrant(maskSize, boxSize, cornerRadius, radius, devicePixelRatio);
+    });
+
+    QBENCHMARK {
+        renderQuadrant(maskSize, boxSize, cornerRadius, radius, devicePixelRatio);
+    }
+}
+
+void BoxShadowRendererBenchmark::stackLayers_data()
+{
+    addShadowMatrix();
+}
+
+void BoxShadowRendererBenchmark::stackLayers()
+{
+    QFETCH(int, preset);
+    QFETCH(int, smallSpacing);
+    QFETCH(qreal, devicePixelRatio);
+
+    QImage canvas;
+    const auto layers = shadowLayers(s_shadowPresets[preset], smallSpacing, devicePixelRatio, canvas);
+
+    AllocationCounter::report([&] {
+        BoxShadowInternal::stackLayers(canvas, layers);
+    });
+
+    QBENCHMARK {
+        BoxShadowInternal::stackLayers(canvas, layers);
+    }
+}
+
+void BoxShadowRendererBenchmark::stackLayersWithPainter_data()
+{
+    addShadowMatrix();
+}
+
+void BoxShadowRendererBenchmark::stackLayersWithPainter()
+{
+    QFETCH(int, preset);
+    QFETCH(int, smallSpacing);
+    QFETCH(qreal, devicePixelRatio);
+
+    QImage canvas;
+    const auto layers = shadowLayers(s_shadowPresets[preset], smallSpacing, devicePixelRatio, canvas);
+
+    AllocationCounter::report([&] {
+        ::stackLayersWithPainter(canvas, layers);
+    });
+
+    QBENCHMARK {
+        ::stackLayersWithPainter(canvas, layers);
+    }
+}
+
+QTEST_GUILESS_MAIN(BoxShadowRendererBenchmark)
+
+#include "boxshadowrendererbenchmark.moc"
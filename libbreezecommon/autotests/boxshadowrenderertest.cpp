@@ -0,0 +1,121 @@
+/*
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+// Checks that blurring only the top-left quadrant of a shadow mask gives the
+// same pixels as blurring the whole mask, for the box sizes the decoration picks.
+
+#include "breezeboxshadowrenderer.h"
+#include "breezeboxshadowrenderer_p.h"
+
+#include <QPainter>
+#include <QTest>
+
+#include <cmath>
+
+using namespace Breeze;
+
+namespace
+{
+// Same as s_shadowParams in breezedecoration.cpp, blur radii only
+struct ShadowPreset {
+    const char *name;
+    int radius1;
+    int radius2;
+};
+
+const ShadowPreset s_shadowPresets[] = {
+    {"none", 0, 0},
+    {"small", 16, 8},
+    {"medium", 32, 16},
+    {"large", 48, 24},
+    {"verylarge", 64, 32},
+};
+
+const qreal s_devicePixelRatios[] = {1.0, 1.5, 2.0};
+
+// The whole mask, rendered and blurred the way render() did before it
+// switched to quadrants
+QImage renderFullMask(const QSize &maskSize, const QSizeF &boxSize, qreal borderRadius, double radius, qreal dpr)
+{
+    QImage shadow(maskSize, QImage::Format_Alpha8);
+    shadow.setDevicePixelRatio(dpr);
+    shadow.fill(Qt::transparent);
+
+    QRectF boxRect(QPoint(0, 0), boxSize);
+    boxRect.moveCenter(QRectF(QPoint(0, 0), QSizeF(maskSize) / dpr).center());
+
+    QPainter painter(&shadow);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(Qt::black);
+    painter.drawRoundedRect(boxRect, 2.0 * borderRadius / boxRect.width(), 2.0 * borderRadius / boxRect.height());
+    painter.end();
+
+    BoxShadowInternal::boxBlurAlpha(shadow, std::round(radius * dpr));
+    return shadow;
+}
+}
+
+class BoxShadowRendererTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void quadrantMatchesFullMask_data();
+    void quadrantMatchesFullMask();
+};
+
+void BoxShadowRendererTest::quadrantMatchesFullMask_data()
+{
+    QTest::addColumn<int>("radius");
+    QTest::addColumn<QSize>("boxSize");
+    QTest::addColumn<qreal>("borderRadius");
+    QTest::addColumn<qreal>("dpr");
+
+    for (const ShadowPreset &preset : s_shadowPresets) {
+        for (int smallSpacing = 2; smallSpacing <= 8; smallSpacing += 2) {
+            // A typical corner radius setting of 3, as the decoration computes it
+            const qreal borderRadius = 0.5 * smallSpacing * 3.5;
+            const QSize boxSize = BoxShadowRenderer::calculateMinimumBoxSize(preset.radius1, borderRadius)
+                                      .expandedTo(BoxShadowRenderer::calculateMinimumBoxSize(preset.radius2, borderRadius));
+
+            for (const qreal dpr : s_devicePixelRatios) {
+                for (const int radius : {preset.radius1, preset.radius2}) {
+                    QTest::addRow("%s radius%d spacing%d dpr%.1f", preset.name, radius, smallSpacing, dpr) << radius << boxSize << borderRadius << dpr;
+                }
+            }
+        }
+    }
+}
+
+void BoxShadowRendererTest::quadrantMatchesFullMask()
+{
+    QFETCH(int, radius);
+    QFETCH(QSize, boxSize);
+    QFETCH(qreal, borderRadius);
+    QFETCH(qreal, dpr);
+
+    const QSize maskSize = BoxShadowInternal::calculateShadowMaskSize(boxSize, radius, dpr);
+    const QImage quadrant = BoxShadowInternal::renderShadowQuadrant(maskSize, boxSize, borderRadius, radius, dpr);
+    const QImage full = renderFullMask(maskSize, boxSize, borderRadius, radius, dpr);
+
+    // The antialiased right and bottom edges of the full mask are rasterized on
+    // their own, at fractional scales they may differ from the mirrored ones by a level.
+    const int tolerance = 2;
+
+    int maximumDifference = 0;
+    for (int y = 0; y < quadrant.height(); ++y) {
+        const uchar *expected = full.constScanLine(y);
+        const uchar *actual = quadrant.constScanLine(y);
+        for (int x = 0; x < quadrant.width(); ++x) {
+            maximumDifference = qMax(maximumDifference, std::abs(int(expected[x]) - int(actual[x])));
+        }
+    }
+
+    QVERIFY2(maximumDifference <= tolerance, qPrintable(QStringLiteral("pixels differ by up to %1").arg(maximumDifference)));
+}
+
+QTEST_GUILESS_MAIN(BoxShadowRendererTest)
+
+#include "boxshadowrenderertest.moc"
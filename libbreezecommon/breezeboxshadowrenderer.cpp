@@ -17,11 +17,21 @@
 
 // own
 #include "breezeboxshadowrenderer.h"
+#include "breezeboxshadowrenderer_p.h"
 
 // Qt
 #include <QPainter>
 #include <QtMath>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define BREEZE_BOXBLUR_AVX2 1
+#endif
+
 namespace Breeze
 {
 static inline int calculateBlurRadius(qreal stdDev)
@@ -163,124 +173,506 @@ static inline void boxBlurRowAlpha(const uint8_t *src,
 }
 
 /**
- * Blur the alpha channel of a given image.
+ * Signature of the kernels that blur a block of columns at once.
  *
- * @param image The input image.
- * @param radius The blur radius.
- * @param rect Specifies what part of the image to blur. If nothing is provided, then
- *    the whole alpha channel of the input image will be blurred.
+ * @param src The top of the block.
+ * @param srcStride The number of bytes from one source row to the next.
+ * @param dst The top of the destination block.
+ * @param dstStride The number of bytes from one destination row to the next.
+ * @param height The height of the columns, in pixels.
+ * @param lobes Params of the box filter.
  **/
-static inline void boxBlurAlpha(QImage &image, int radius, const QRect &rect = {})
+using BoxBlurColumnsFunc = void (*)(const uint8_t *src, int srcStride, uint8_t *dst, int dstStride, int height, const BoxLobes &lobes);
+
+//* number of adjacent columns the vectorized kernels process per iteration
+static constexpr int s_columnBlockSize = 16;
+
+#if defined(__SSE2__)
+static inline void widenSse2(const uint8_t *src, __m128i out[4])
 {
-    if (radius < 2) {
-        return;
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+    const __m128i lo = _mm_unpacklo_epi8(bytes, zero);
+    const __m128i hi = _mm_unpackhi_epi8(bytes, zero);
+    out[0] = _mm_unpacklo_epi16(lo, zero);
+    out[1] = _mm_unpackhi_epi16(lo, zero);
+    out[2] = _mm_unpacklo_epi16(hi, zero);
+    out[3] = _mm_unpackhi_epi16(hi, zero);
+}
+
+static inline __m128i scaleSse2(__m128i sum, __m128i reciprocal)
+{
+    // SSE2 has no 32 bit low multiply, but the products never exceed
+    // 32 bits, so two widening multiplies give the exact scalar result.
+    const __m128i even = _mm_srli_epi64(_mm_mul_epu32(sum, reciprocal), 24);
+    const __m128i odd = _mm_srli_epi64(_mm_mul_epu32(_mm_srli_epi64(sum, 32), reciprocal), 24);
+    return _mm_or_si128(even, _mm_slli_epi64(odd, 32));
+}
+
+static inline void storeSse2(uint8_t *dst, const __m128i sum[4], __m128i reciprocal)
+{
+    const __m128i lo = _mm_packs_epi32(scaleSse2(sum[0], reciprocal), scaleSse2(sum[1], reciprocal));
+    const __m128i hi = _mm_packs_epi32(scaleSse2(sum[2], reciprocal), scaleSse2(sum[3], reciprocal));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), _mm_packus_epi16(lo, hi));
+}
+
+/**
+ * SSE2 version of boxBlurRowAlpha() that blurs 16 adjacent columns of
+ * a packed alpha plane at once.
+ **/
+static void boxBlurColumnsSse2(const uint8_t *src, int srcStride, uint8_t *dst, int dstStride, int height, const BoxLobes &lobes)
+{
+    const int boxSize = lobes.left + 1 + lobes.right;
+    const __m128i reciprocal = _mm_set1_epi32((1 << 24) / boxSize);
+
+    const uint8_t *lastRow = src + (height - 1) * srcStride;
+
+    alignas(16) uint32_t initialSum[s_columnBlockSize];
+    for (int i = 0; i < s_columnBlockSize; ++i) {
+        initialSum[i] = (boxSize + 1) / 2 + src[i] * lobes.left;
     }
 
-    const QVector<BoxLobes> lobes = computeLobes(radius);
+    __m128i first[4];
+    __m128i last[4];
+    __m128i sum[4];
+    __m128i in[4];
+    __m128i out[4];
+    widenSse2(src, first);
+    widenSse2(lastRow, last);
+    for (int k = 0; k < 4; ++k) {
+        sum[k] = _mm_load_si128(reinterpret_cast<const __m128i *>(initialSum) + k);
+    }
 
-    const QRect blurRect = rect.isNull() ? image.rect() : rect;
+    int left = 0;
+    int right = 0;
+    int row = 0;
 
-    const int alphaOffset = QSysInfo::ByteOrder == QSysInfo::BigEndian ? 0 : 3;
-    const int width = blurRect.width();
-    const int height = blurRect.height();
-    const int rowStride = image.bytesPerLine();
-    const int pixelStride = image.depth() >> 3;
+    for (; right < boxSize - lobes.left; ++right) {
+        widenSse2(src + right * srcStride, in);
+        for (int k = 0; k < 4; ++k) {
+            sum[k] = _mm_add_epi32(sum[k], in[k]);
+        }
+    }
+
+    for (; right < boxSize; ++right, ++row) {
+        storeSse2(dst + row * dstStride, sum, reciprocal);
+        widenSse2(src + right * srcStride, in);
+        for (int k = 0; k < 4; ++k) {
+            sum[k] = _mm_add_epi32(sum[k], _mm_sub_epi32(in[k], first[k]));
+        }
+    }
+
+    for (; right < height; ++right, ++left, ++row) {
+        storeSse2(dst + row * dstStride, sum, reciprocal);
+        widenSse2(src + right * srcStride, in);
+        widenSse2(src + left * srcStride, out);
+        for (int k = 0; k < 4; ++k) {
+            sum[k] = _mm_add_epi32(sum[k], _mm_sub_epi32(in[k], out[k]));
+        }
+    }
+
+    for (; row < height; ++left, ++row) {
+        storeSse2(dst + row * dstStride, sum, reciprocal);
+        widenSse2(src + left * srcStride, out);
+        for (int k = 0; k < 4; ++k) {
+            sum[k] = _mm_add_epi32(sum[k], _mm_sub_epi32(last[k], out[k]));
+        }
+    }
+}
+#endif
+
+#if BREEZE_BOXBLUR_AVX2
+__attribute__((target("avx2"))) static inline void widenAvx2(const uint8_t *src, __m256i out[2])
+{
+    const __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src));
+    out[0] = _mm256_cvtepu8_epi32(bytes);
+    out[1] = _mm256_cvtepu8_epi32(_mm_srli_si128(bytes, 8));
+}
 
-    const int bufferStride = qMax(width, height) * pixelStride;
+__attribute__((target("avx2"))) static inline void storeAvx2(uint8_t *dst, const __m256i sum[2], __m256i reciprocal)
+{
+    const __m256i lo = _mm256_srli_epi32(_mm256_mullo_epi32(sum[0], reciprocal), 24);
+    const __m256i hi = _mm256_srli_epi32(_mm256_mullo_epi32(sum[1], reciprocal), 24);
+
+    // packus works within 128 bit lanes, so restore the column order before narrowing again.
+    const __m256i words = _mm256_permute4x64_epi64(_mm256_packus_epi32(lo, hi), _MM_SHUFFLE(3, 1, 2, 0));
+    const __m128i bytes = _mm_packus_epi16(_mm256_castsi256_si128(words), _mm256_extracti128_si256(words, 1));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(dst), bytes);
+}
+
+/**
+ * AVX2 version of boxBlurRowAlpha() that blurs 16 adjacent columns of
+ * a packed alpha plane at once.
+ **/
+__attribute__((target("avx2"))) static void boxBlurColumnsAvx2(const uint8_t *src, int srcStride, uint8_t *dst, int dstStride, int height, const BoxLobes &lobes)
+{
+    const int boxSize = lobes.left + 1 + lobes.right;
+    const __m256i reciprocal = _mm256_set1_epi32((1 << 24) / boxSize);
+    const __m256i bias = _mm256_set1_epi32((boxSize + 1) / 2);
+    const __m256i leftLobe = _mm256_set1_epi32(lobes.left);
+
+    const uint8_t *lastRow = src + (height - 1) * srcStride;
+
+    __m256i first[2];
+    __m256i last[2];
+    __m256i sum[2];
+    __m256i in[2];
+    __m256i out[2];
+    widenAvx2(src, first);
+    widenAvx2(lastRow, last);
+    for (int k = 0; k < 2; ++k) {
+        sum[k] = _mm256_add_epi32(bias, _mm256_mullo_epi32(first[k], leftLobe));
+    }
+
+    int left = 0;
+    int right = 0;
+    int row = 0;
+
+    for (; right < boxSize - lobes.left; ++right) {
+        widenAvx2(src + right * srcStride, in);
+        for (int k = 0; k < 2; ++k) {
+            sum[k] = _mm256_add_epi32(sum[k], in[k]);
+        }
+    }
+
+    for (; right < boxSize; ++right, ++row) {
+        storeAvx2(dst + row * dstStride, sum, reciprocal);
+        widenAvx2(src + right * srcStride, in);
+        for (int k = 0; k < 2; ++k) {
+            sum[k] = _mm256_add_epi32(sum[k], _mm256_sub_epi32(in[k], first[k]));
+        }
+    }
+
+    for (; right < height; ++right, ++left, ++row) {
+        storeAvx2(dst + row * dstStride, sum, reciprocal);
+        widenAvx2(src + right * srcStride, in);
+        widenAvx2(src + left * srcStride, out);
+        for (int k = 0; k < 2; ++k) {
+            sum[k] = _mm256_add_epi32(sum[k], _mm256_sub_epi32(in[k], out[k]));
+        }
+    }
+
+    for (; row < height; ++left, ++row) {
+        storeAvx2(dst + row * dstStride, sum, reciprocal);
+        widenAvx2(src + left * srcStride, out);
+        for (int k = 0; k < 2; ++k) {
+            sum[k] = _mm256_add_epi32(sum[k], _mm256_sub_epi32(last[k], out[k]));
+        }
+    }
+}
+#endif
+
+/**
+ * Pick the fastest column kernel the CPU supports.
+ *
+ * @returns The kernel, or nullptr if only the scalar path is available.
+ **/
+static BoxBlurColumnsFunc resolveBoxBlurColumns()
+{
+#if BREEZE_BOXBLUR_AVX2
+    if (__builtin_cpu_supports("avx2")) {
+        return boxBlurColumnsAvx2;
+    }
+#endif
+#if defined(__SSE2__)
+    return boxBlurColumnsSse2;
+#else
+    return nullptr;
+#endif
+}
+
+/**
+ * Blur a packed 8-bit alpha plane.
+ *
+ * @param plane The first byte of the plane.
+ * @param width The width of the plane, in pixels.
+ * @param height The height of the plane, in pixels.
+ * @param stride The number of bytes from one row to the next row.
+ * @param radius The blur radius.
+ **/
+static void boxBlurPlane(uint8_t *plane, int width, int height, int stride, int radius)
+{
+    static const BoxBlurColumnsFunc blurColumns = resolveBoxBlurColumns();
+
+    const QVector<BoxLobes> lobes = computeLobes(radius);
+
+    const int bufferStride = qMax(width, height);
     QScopedPointer<uint8_t, QScopedPointerArrayDeleter<uint8_t>> buf(new uint8_t[2 * bufferStride]);
     uint8_t *buf1 = buf.data();
     uint8_t *buf2 = buf1 + bufferStride;
 
     // Blur the image in horizontal direction.
     for (int i = 0; i < height; ++i) {
-        uint8_t *row = image.scanLine(blurRect.y() + i) + blurRect.x() * pixelStride + alphaOffset;
-        boxBlurRowAlpha(row, buf1, width, pixelStride, rowStride, lobes[0], false, false);
-        boxBlurRowAlpha(buf1, buf2, width, pixelStride, rowStride, lobes[1], false, false);
-        boxBlurRowAlpha(buf2, row, width, pixelStride, rowStride, lobes[2], false, false);
+        uint8_t *row = plane + i * stride;
+        boxBlurRowAlpha(row, buf1, width, 1, stride, lobes[0], false, false);
+        boxBlurRowAlpha(buf1, buf2, width, 1, stride, lobes[1], false, false);
+        boxBlurRowAlpha(buf2, row, width, 1, stride, lobes[2], false, false);
     }
 
-    // Blur the image in vertical direction.
-    for (int i = 0; i < width; ++i) {
-        uint8_t *column = image.scanLine(blurRect.y()) + (blurRect.x() + i) * pixelStride + alphaOffset;
-        boxBlurRowAlpha(column, buf1, height, pixelStride, rowStride, lobes[0], true, false);
-        boxBlurRowAlpha(buf1, buf2, height, pixelStride, rowStride, lobes[1], false, false);
-        boxBlurRowAlpha(buf2, column, height, pixelStride, rowStride, lobes[2], false, true);
+    // Blur the image in vertical direction, several columns at a time where possible.
+    int i = 0;
+    if (blurColumns && width >= s_columnBlockSize) {
+        const int blockStride = s_columnBlockSize * height;
+        QScopedPointer<uint8_t, QScopedPointerArrayDeleter<uint8_t>> block(new uint8_t[2 * blockStride]);
+        uint8_t *block1 = block.data();
+        uint8_t *block2 = block1 + blockStride;
+
+        for (; i + s_columnBlockSize <= width; i += s_columnBlockSize) {
+            uint8_t *columns = plane + i;
+            blurColumns(columns, stride, block1, s_columnBlockSize, height, lobes[0]);
+            blurColumns(block1, s_columnBlockSize, block2, s_columnBlockSize, height, lobes[1]);
+            blurColumns(block2, s_columnBlockSize, columns, stride, height, lobes[2]);
+        }
+    }
+
+    for (; i < width; ++i) {
+        uint8_t *column = plane + i;
+        boxBlurRowAlpha(column, buf1, height, 1, stride, lobes[0], true, false);
+        boxBlurRowAlpha(buf1, buf2, height, 1, stride, lobes[1], false, false);
+        boxBlurRowAlpha(buf2, column, height, 1, stride, lobes[2], false, true);
     }
 }
 
-static inline void mirrorTopLeftQuadrant(QImage &image)
+namespace BoxShadowInternal
 {
-    const int width = image.width();
-    const int height = image.height();
+void boxBlurAlpha(QImage &image, int radius, const QRect &rect)
+{
+    if (radius < 2) {
+        return;
+    }
 
-    const int centerX = qCeil(width * 0.5);
-    const int centerY = qCeil(height * 0.5);
+    const QRect blurRect = rect.isNull() ? image.rect() : rect;
 
-    const int alphaOffset = QSysInfo::ByteOrder == QSysInfo::BigEndian ? 0 : 3;
-    const int stride = image.depth() >> 3;
+    const int width = blurRect.width();
+    const int height = blurRect.height();
+    const int rowStride = image.bytesPerLine();
+    const int pixelStride = image.depth() >> 3;
+
+    if (pixelStride == 1) {
+        boxBlurPlane(image.scanLine(blurRect.y()) + blurRect.x(), width, height, rowStride, radius);
+        return;
+    }
 
-    for (int y = 0; y < centerY; ++y) {
-        uint8_t *in = image.scanLine(y) + alphaOffset;
-        uint8_t *out = in + (width - 1) * stride;
+    // De-interleave the alpha channel so that both passes walk packed bytes.
+    const int alphaOffset = QSysInfo::ByteOrder == QSysInfo::BigEndian ? 0 : 3;
+    QScopedPointer<uint8_t, QScopedPointerArrayDeleter<uint8_t>> plane(new uint8_t[width * height]);
 
-        for (int x = 0; x < centerX; ++x, in += stride, out -= stride) {
-            *out = *in;
+    for (int y = 0; y < height; ++y) {
+        const uint8_t *in = image.constScanLine(blurRect.y() + y) + blurRect.x() * pixelStride + alphaOffset;
+        uint8_t *out = plane.data() + y * width;
+        for (int x = 0; x < width; ++x, in += pixelStride) {
+            out[x] = *in;
         }
     }
 
-    for (int y = 0; y < centerY; ++y) {
-        const uint8_t *in = image.scanLine(y) + alphaOffset;
-        uint8_t *out = image.scanLine(width - y - 1) + alphaOffset;
+    boxBlurPlane(plane.data(), width, height, width, radius);
 
-        for (int x = 0; x < width; ++x, in += stride, out += stride) {
-            *out = *in;
+    for (int y = 0; y < height; ++y) {
+        const uint8_t *in = plane.data() + y * width;
+        uint8_t *out = image.scanLine(blurRect.y() + y) + blurRect.x() * pixelStride + alphaOffset;
+        for (int x = 0; x < width; ++x, out += pixelStride) {
+            *out = in[x];
         }
     }
 }
 
-static void renderShadow(QPainter *painter, const QRectF &rect, qreal borderRadius, const QPointF &offset, double radius, const QColor &color)
+QSize calculateShadowMaskSize(const QSizeF &boxSize, double radius, qreal dpr)
 {
-    const qreal dpr = painter->device()->devicePixelRatioF();
     const QSize inflation = calculateBlurExtent(radius);
-    const QSize pixelSize = ((rect.size() + 2 * inflation) * dpr).toSize();
-    const QSizeF size = QSizeF(pixelSize) / dpr;
+    return ((boxSize + 2 * inflation) * dpr).toSize();
+}
+
+QImage renderShadowQuadrant(const QSize &maskSize, const QSizeF &boxSize, qreal borderRadius, double radius, qreal dpr)
+{
+    const QSizeF size = QSizeF(maskSize) / dpr;
 
-    QImage shadow(pixelSize, QImage::Format_ARGB32_Premultiplied);
+    QImage shadow(std::ceil(maskSize.width() * 0.5), std::ceil(maskSize.height() * 0.5), QImage::Format_Alpha8);
     shadow.setDevicePixelRatio(dpr);
     shadow.fill(Qt::transparent);
 
-    QRectF boxRect(QPoint(0, 0), rect.size());
+    QRectF boxRect(QPoint(0, 0), boxSize);
     boxRect.moveCenter(QRectF(QPoint(0, 0), size).center());
 
     const qreal xRadius = 2.0 * borderRadius / boxRect.width();
     const qreal yRadius = 2.0 * borderRadius / boxRect.height();
 
-    QPainter shadowPainter;
-    shadowPainter.begin(&shadow);
+    // Whatever falls outside of the quadrant is clipped away by the painter.
+    QPainter shadowPainter(&shadow);
     shadowPainter.setRenderHint(QPainter::Antialiasing);
     shadowPainter.setPen(Qt::NoPen);
     shadowPainter.setBrush(Qt::black);
     shadowPainter.drawRoundedRect(boxRect, xRadius, yRadius);
     shadowPainter.end();
 
-    // Because the shadow texture is symmetrical, that's enough to blur
-    // only the top-left quadrant and then mirror it.
-    const QRect blurRect(0, 0, std::ceil(shadow.width() * 0.5), std::ceil(shadow.height() * 0.5));
     const int scaledRadius = std::round(radius * dpr);
-    boxBlurAlpha(shadow, scaledRadius, blurRect);
-    mirrorTopLeftQuadrant(shadow);
 
-    // Give the shadow a tint of the desired color.
-    shadowPainter.begin(&shadow);
-    shadowPainter.setCompositionMode(QPainter::CompositionMode_SourceIn);
-    shadowPainter.fillRect(shadow.rect(), color);
-    shadowPainter.end();
+    // The blur is clamped at the right and bottom edges of the quadrant instead of reading
+    // the mirrored half of the mask. Both agree only while the straight part of each edge
+    // of the box reaches further than the blur, see calculateMinimumBoxSize(int, qreal).
+    Q_ASSERT(0.5 * qMin(boxSize.width(), boxSize.height()) * dpr - borderRadius * dpr >= calculateBlurExtent(scaledRadius).width());
+
+    boxBlurAlpha(shadow, scaledRadius);
 
-    // Actually, present the shadow.
-    QRectF shadowRect = shadow.rect();
-    shadowRect.setSize(shadowRect.size() / dpr);
-    shadowRect.moveCenter(rect.center() + offset);
-    painter->drawImage(shadowRect, shadow);
+    return shadow;
+}
+
+} // namespace BoxShadowInternal
+
+/**
+ * Multiply an 8-bit value by an 8-bit alpha, rounding like QPainter does.
+ **/
+static inline uint multiplyAlpha(uint value, uint alpha)
+{
+    const uint t = value * alpha + 0x80;
+    return (t + (t >> 8)) >> 8;
+}
+
+/**
+ * Integrate a gaussian blurred rounded box along the x axis.
+ *
+ * @param x The horizontal distance from the center of the box.
+ * @param y The vertical distance from the center of the box.
+ * @param sigma The standard deviation of the gaussian.
+ * @param corner The radius of the corners.
+ * @param halfSize Half the size of the box.
+ **/
+static inline qreal roundedBoxShadowX(qreal x, qreal y, qreal sigma, qreal corner, const QSizeF &halfSize)
+{
+    const qreal delta = qMin(halfSize.height() - corner - std::abs(y), 0.0);
+    const qreal curved = halfSize.width() - corner + std::sqrt(qMax(0.0, corner * corner - delta * delta));
+    const qreal scale = M_SQRT1_2 / sigma;
+    return 0.5 * (std::erf((x + curved) * scale) - std::erf((x - curved) * scale));
+}
+
+/**
+ * Evaluate a gaussian blurred rounded box.
+ *
+ * The blur is exact along the x axis and sampled along the y axis, see
+ * https://madebyevan.com/shaders/fast-rounded-rectangle-shadows/
+ *
+ * @param point The position relative to the center of the box.
+ * @param halfSize Half the size of the box.
+ * @param sigma The standard deviation of the gaussian.
+ * @param corner The radius of the corners.
+ * @returns The coverage, between 0 and 1.
+ **/
+static inline qreal roundedBoxShadow(const QPointF &point, const QSizeF &halfSize, qreal sigma, qreal corner)
+{
+    const int samples = 4;
+
+    const qreal low = point.y() - halfSize.height();
+    const qreal high = point.y() + halfSize.height();
+    const qreal start = qBound(low, -3.0 * sigma, high);
+    const qreal end = qBound(low, 3.0 * sigma, high);
+    const qreal step = (end - start) / samples;
+
+    qreal value = 0.0;
+    qreal y = start + 0.5 * step;
+    for (int i = 0; i < samples; ++i, y += step) {
+        const qreal gaussian = std::exp(-y * y / (2.0 * sigma * sigma)) / (std::sqrt(2.0 * M_PI) * sigma);
+        value += roundedBoxShadowX(point.x(), point.y() - y, sigma, corner, halfSize) * gaussian * step;
+    }
+
+    return value;
+}
+
+namespace BoxShadowInternal
+{
+QImage renderAnalyticShadowQuadrant(const QSize &maskSize, const QSizeF &boxSize, qreal borderRadius, double radius, qreal dpr)
+{
+    QImage shadow(std::ceil(maskSize.width() * 0.5), std::ceil(maskSize.height() * 0.5), QImage::Format_Alpha8);
+    shadow.setDevicePixelRatio(dpr);
+
+    // Work in device pixels, with the origin at the center of the mask.
+    const QSizeF halfSize = boxSize * dpr * 0.5;
+    const QPointF center = QPointF(maskSize.width(), maskSize.height()) * 0.5;
+    const qreal sigma = calculateBlurStdDev(std::round(radius * dpr));
+
+    // Use the same corner the box blur engine passes to drawRoundedRect().
+    const qreal corner = qMin(2.0 * borderRadius / boxSize.width() * dpr, qMin(halfSize.width(), halfSize.height()));
+
+    for (int y = 0; y < shadow.height(); ++y) {
+        uint8_t *out = shadow.scanLine(y);
+        for (int x = 0; x < shadow.width(); ++x) {
+            const QPointF point = QPointF(x + 0.5, y + 0.5) - center;
+            out[x] = qBound(0, qRound(255 * roundedBoxShadow(point, halfSize, sigma, corner)), 255);
+        }
+    }
+
+    return shadow;
+}
+
+} // namespace BoxShadowInternal
+
+/**
+ * Blend a premultiplied color with a given coverage onto a pixel, source over.
+ **/
+static inline void blendCoverage(QRgb &pixel, QRgb color, uint coverage)
+{
+    if (!coverage) {
+        return;
+    }
+
+    const uint srcAlpha = multiplyAlpha(qAlpha(color), coverage);
+    const uint inverse = 255 - srcAlpha;
+    pixel = qRgba(multiplyAlpha(qRed(color), coverage) + multiplyAlpha(qRed(pixel), inverse),
+                  multiplyAlpha(qGreen(color), coverage) + multiplyAlpha(qGreen(pixel), inverse),
+                  multiplyAlpha(qBlue(color), coverage) + multiplyAlpha(qBlue(pixel), inverse),
+                  srcAlpha + multiplyAlpha(qAlpha(pixel), inverse));
+}
+
+namespace BoxShadowInternal
+{
+void stackLayers(QImage &canvas, const QList<ShadowLayer> &layers)
+{
+    canvas.fill(Qt::transparent);
+
+    uchar *canvasBits = canvas.bits();
+    const qsizetype canvasStride = canvas.bytesPerLine();
+
+    // Layers go down one after the other, each one only walking the pixels it covers.
+    // The other three quadrants of each mask are read mirrored from the top-left one.
+    for (const ShadowLayer &layer : layers) {
+        const QRect area = layer.rect & canvas.rect();
+        if (area.isEmpty()) {
+            continue;
+        }
+
+        const uchar *maskBits = layer.quadrant.constBits();
+        const qsizetype maskStride = layer.quadrant.bytesPerLine();
+        const int maskHeight = layer.quadrant.height();
+
+        // Columns left of mirrorX read the quadrant forward, the others read it backward.
+        const int mirrorX = layer.rect.x() + layer.quadrant.width();
+        const int forwardEnd = qMin(area.right() + 1, mirrorX);
+        const int backwardStart = qMax(area.left(), mirrorX);
+        const int backwardOrigin = layer.rect.x() + layer.rect.width() - 1;
+
+        for (int y = area.top(); y <= area.bottom(); ++y) {
+            int maskY = y - layer.rect.y();
+            if (maskY >= maskHeight) {
+                maskY = layer.rect.height() - 1 - maskY;
+            }
+
+            const uchar *mask = maskBits + maskY * maskStride;
+            QRgb *out = reinterpret_cast<QRgb *>(canvasBits + y * canvasStride);
+
+            for (int x = area.left(); x < forwardEnd; ++x) {
+                blendCoverage(out[x], layer.color, mask[x - layer.rect.x()]);
+            }
+
+            for (int x = backwardStart; x <= area.right(); ++x) {
+                blendCoverage(out[x], layer.color, mask[backwardOrigin - x]);
+            }
+        }
+    }
+}
+
+} // namespace BoxShadowInternal
+
+BoxShadowRenderer::BoxShadowRenderer(Engine engine)
+    : m_engine(engine)
+{
 }
 
 void BoxShadowRenderer::setBoxSize(const QSizeF &size)
@@ -293,6 +685,11 @@ void BoxShadowRenderer::setBorderRadius(qreal radius)
     m_borderRadius = radius;
 }
 
+void BoxShadowRenderer::setDevicePixelRatio(qreal dpr)
+{
+    m_devicePixelRatio = dpr;
+}
+
 void BoxShadowRenderer::addShadow(const QPointF &offset, double radius, const QColor &color)
 {
     Shadow shadow = {};
@@ -304,6 +701,8 @@ void BoxShadowRenderer::addShadow(const QPointF &offset, double radius, const QC
 
 QImage BoxShadowRenderer::render() const
 {
+    using namespace BoxShadowInternal;
+
     if (m_shadows.isEmpty()) {
         return {};
     }
@@ -313,17 +712,34 @@ QImage BoxShadowRenderer::render() const
         canvasSize = canvasSize.expandedTo(calculateMinimumShadowTextureSize(m_boxSize, shadow.radius, shadow.offset));
     }
 
-    QImage canvas(canvasSize.toSize(), QImage::Format_ARGB32_Premultiplied);
-    canvas.fill(Qt::transparent);
+    // The canvas is sized in device pixels, while the box and the shadows stay
+    // in logical coordinates.
+    const qreal dpr = m_devicePixelRatio;
+    QImage canvas((canvasSize * dpr).toSize(), QImage::Format_ARGB32_Premultiplied);
+    canvas.setDevicePixelRatio(dpr);
 
     QRectF boxRect(QPoint(0, 0), m_boxSize);
-    boxRect.moveCenter(QRect(QPoint(0, 0), canvas.size()).center());
+    boxRect.moveCenter(QPointF(QRect(QPoint(0, 0), canvas.size()).center()) / dpr);
 
-    QPainter painter(&canvas);
+    // Each shadow is blurred as a bare alpha mask, only the final texture is
+    // ARGB, so the tint is applied while stacking the masks below.
+    QList<ShadowLayer> layers;
+    layers.reserve(m_shadows.size());
     for (const Shadow &shadow : std::as_const(m_shadows)) {
-        renderShadow(&painter, boxRect, m_borderRadius, shadow.offset, shadow.radius, shadow.color);
+        const QSize maskSize = calculateShadowMaskSize(m_boxSize, shadow.radius, dpr);
+
+        ShadowLayer layer;
+        layer.quadrant = m_engine == Engine::Analytic ? renderAnalyticShadowQuadrant(maskSize, m_boxSize, m_borderRadius, shadow.radius, dpr)
+                                                      : renderShadowQuadrant(maskSize, m_boxSize, m_borderRadius, shadow.radius, dpr);
+
+        QRectF shadowRect(QPointF(0, 0), QSizeF(maskSize) / dpr);
+        shadowRect.moveCenter(boxRect.center() + shadow.offset);
+        layer.rect = QRect(QPoint(qRound(shadowRect.x() * dpr), qRound(shadowRect.y() * dpr)), maskSize);
+        layer.color = qPremultiply(shadow.color.rgba());
+        layers.append(layer);
     }
-    painter.end();
+
+    stackLayers(canvas, layers);
 
     return canvas;
 }
@@ -334,6 +750,13 @@ QSize BoxShadowRenderer::calculateMinimumBoxSize(int radius)
     return 2 * blurExtent + QSize(1, 1);
 }
 
+QSize BoxShadowRenderer::calculateMinimumBoxSize(int radius, qreal borderRadius)
+{
+    // One more pixel on each side absorbs the rounding of the blur radius to device pixels.
+    const int corner = qCeil(borderRadius) + 1;
+    return calculateMinimumBoxSize(radius) + 2 * QSize(corner, corner);
+}
+
 QSizeF BoxShadowRenderer::calculateMinimumShadowTextureSize(const QSizeF &boxSize, double radius, const QPointF &offset)
 {
     return boxSize + 2 * calculateBlurExtent(radius) + QSizeF(std::abs(offset.x()), std::abs(offset.y()));
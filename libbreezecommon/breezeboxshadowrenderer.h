@@ -18,7 +18,19 @@
  class BREEZECOMMON_EXPORT BoxShadowRenderer
  {
  public:
-     // Compiler generated constructors & destructor are fine.
+     /**
+      * The algorithm used to compute the shadows.
+      **/
+     enum class Engine {
+         BoxBlur, ///< Rasterize the box and approximate a gaussian blur with three box blurs.
+         Analytic, ///< Evaluate the gaussian blurred rounded box in closed form.
+     };
+ 
+     /**
+      * Constructor.
+      * @param engine The algorithm used to compute the shadows.
+      **/
+     explicit BoxShadowRenderer(Engine engine = Engine::BoxBlur);
  
      /**
       * Set the size of the box.
@@ -31,6 +43,12 @@
       * @param radius The border radius, in pixels.
       **/
      void setBorderRadius(qreal radius);
+
+     /**
+      * Set the device pixel ratio of the resulting shadow texture.
+      * @param dpr The device pixel ratio.
+      **/
+     void setDevicePixelRatio(qreal dpr);
  
      /**
       * Add a shadow.
@@ -54,6 +72,19 @@
       * @param radius The blur radius of the shadow.
       **/
      static QSize calculateMinimumBoxSize(int radius);
+
+     /**
+      * Calculate the minimum size of a box with rounded corners.
+      *
+      * Only the top-left quadrant of each shadow is blurred and then mirrored.
+      * That is exact as long as the straight part of every edge reaches further
+      * than the blur does, so the box grows by the corners on top of
+      * calculateMinimumBoxSize(int).
+      *
+      * @param radius The blur radius of the shadow.
+      * @param borderRadius The border radius of the box.
+      **/
+     static QSize calculateMinimumBoxSize(int radius, qreal borderRadius);
  
      /**
       * Calculate the minimum size of the shadow texture.
@@ -68,8 +99,10 @@
      static QSizeF calculateMinimumShadowTextureSize(const QSizeF &boxSize, double radius, const QPointF &offset);
  
  private:
+     Engine m_engine;
      QSizeF m_boxSize;
      qreal m_borderRadius = 0.0;
+     qreal m_devicePixelRatio = 1.0;
  
      struct Shadow {
          QPointF offset;
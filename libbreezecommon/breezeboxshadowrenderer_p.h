@@ -0,0 +1,84 @@
+/*
+ * SPDX-FileCopyrightText: 2018 Vlad Zahorodnii <vlad.zahorodnii@kde.org>
+ *
+ * SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#pragma once
+
+// Internal steps of BoxShadowRenderer::render(). None of this is exported,
+// the tests and benchmarks compile the renderer into a static library of their own.
+
+// Qt
+#include <QImage>
+#include <QList>
+#include <QRect>
+#include <QSize>
+
+namespace Breeze
+{
+namespace BoxShadowInternal
+{
+/**
+ * Blur the alpha channel of a given image.
+ *
+ * @param image The input image.
+ * @param radius The blur radius.
+ * @param rect Specifies what part of the image to blur. If nothing is provided, then
+ *    the whole alpha channel of the input image will be blurred.
+ **/
+void boxBlurAlpha(QImage &image, int radius, const QRect &rect = {});
+
+/**
+ * Compute the size of the alpha mask of a single shadow.
+ *
+ * @param boxSize The size of the box, in logical pixels.
+ * @param radius The blur radius.
+ * @param dpr The device pixel ratio of the mask.
+ * @returns The size of the mask, in device pixels.
+ **/
+QSize calculateShadowMaskSize(const QSizeF &boxSize, double radius, qreal dpr);
+
+/**
+ * Render the top-left quadrant of the alpha mask of a single shadow.
+ *
+ * The mask is symmetrical, so the quadrant, which also holds the center
+ * row and column KWin stretches into the shadow edges, is all that is
+ * needed to assemble the nine-patch texture.
+ *
+ * @param maskSize The size of the whole mask, in device pixels.
+ * @param boxSize The size of the box, in logical pixels.
+ * @param borderRadius The border radius of the box.
+ * @param radius The blur radius.
+ * @param dpr The device pixel ratio of the mask.
+ * @returns A Format_Alpha8 image holding the blurred quadrant.
+ **/
+QImage renderShadowQuadrant(const QSize &maskSize, const QSizeF &boxSize, qreal borderRadius, double radius, qreal dpr);
+
+/**
+ * Evaluate the top-left quadrant of the alpha mask of a single shadow in
+ * closed form, without rasterizing or blurring anything.
+ *
+ * @see renderShadowQuadrant
+ **/
+QImage renderAnalyticShadowQuadrant(const QSize &maskSize, const QSizeF &boxSize, qreal borderRadius, double radius, qreal dpr);
+
+/**
+ * The blurred alpha mask of a single shadow, placed on the texture.
+ **/
+struct ShadowLayer {
+    QImage quadrant; ///< The top-left quadrant of the mask, see renderShadowQuadrant().
+    QRect rect; ///< Where the whole mask lands on the texture, in device pixels.
+    QRgb color; ///< The premultiplied color of the shadow.
+};
+
+/**
+ * Tint the layers and stack them onto the texture, source over, in the order given.
+ *
+ * @param canvas The ARGB32_Premultiplied texture, its previous content is discarded.
+ * @param layers The layers to stack.
+ **/
+void stackLayers(QImage &canvas, const QList<ShadowLayer> &layers);
+
+} // namespace BoxShadowInternal
+} // namespace Breeze